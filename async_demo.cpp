@@ -0,0 +1,68 @@
+// async_demo.cpp – AsyncDeque with C++20 coroutines: a bounded pipeline
+// where the producer is throttled by backpressure and the consumer sleeps
+// (suspends) instead of polling.
+#include <coroutine>
+#include <exception>
+#include <iostream>
+
+#include "doubly_linked_list.hpp"
+
+using std::cout;
+using std::endl;
+
+// Task – the smallest fire-and-forget coroutine: starts eagerly, frees its
+// frame when it finishes.
+struct Task {
+    struct promise_type {
+        Task                get_return_object() { return {}; }
+        std::suspend_never  initial_suspend() noexcept { return {}; }
+        std::suspend_never  final_suspend() noexcept { return {}; }
+        void                return_void() {}
+        void                unhandled_exception() { std::terminate(); }
+    };
+};
+
+Task produce(AsyncDeque<int>& q, int count) {
+    for (int i = 1; i <= count; ++i) {
+        cout << "  push " << i << (q.size() == q.capacity() ? " (waits)" : "") << endl;
+        co_await q.push_back(i);
+    }
+    q.close();
+}
+
+Task consume(AsyncDeque<int>& q, long& total) {
+    while (std::optional<int> v = co_await q.pop_front()) {
+        cout << "  pop  " << *v << endl;
+        total += *v;
+    }
+    cout << "  closed and drained" << endl;
+}
+
+int main() {
+    // The producer runs first: two values fit, the third push suspends.
+    // Each pop then frees a slot, which moves the waiting value in and
+    // resumes the producer for its next push.
+    AsyncDeque<int> q(2);
+    long            total = 0;
+    cout << "Bounded AsyncDeque (capacity " << q.capacity() << "):" << endl;
+    produce(q, 5);
+    consume(q, total);
+    cout << "total = " << total << endl;   // 15
+
+    // The other way round, each push hands its value straight to the
+    // suspended consumer; nothing is ever queued.
+    AsyncDeque<int> h;
+    total = 0;
+    cout << "Hand-off:" << endl;
+    consume(h, total);
+    produce(h, 3);
+    cout << "total = " << total << endl;   // 6
+
+    // try_* never suspend.
+    AsyncDeque<int> r(1);
+    bool first  = r.try_push_back(7);
+    bool second = r.try_push_back(8);
+    cout << "try_push_back: " << first << " " << second
+         << ", try_pop_front: " << r.try_pop_front().value_or(-1) << endl;   // 1 0, 7
+    return 0;
+}
@@ -0,0 +1,695 @@
+/*
+ dll_bench – Google Benchmark suite for DoublyLinkedList and its variants
+  against std::list and std::deque.
+
+ Every benchmark reports, besides the library's own timings:
+   ns/op            wall time of the measured region divided by operations
+   allocs/op        global operator new calls inside the measured region
+   cache-misses/op  hardware cache misses (Linux perf events; omitted when
+                    the kernel or container does not expose them)
+
+ Sizes run from 1e2 to DLL_BENCH_MAX_N (1e8 unless the build overrides it);
+ use --benchmark_filter to pick a subset.
+ */
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <new>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "doubly_linked_list.hpp"
+
+#ifndef DLL_BENCH_MAX_N
+#define DLL_BENCH_MAX_N 100000000
+#endif
+
+/* -----------------------------------------------------------
+   Allocation counting: every global operator new bumps a counter.
+----------------------------------------------------------------*/
+static std::size_t g_allocations = 0;
+
+void* operator new(std::size_t n) {
+    ++g_allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void  operator delete(void* p) noexcept { std::free(p); }
+void  operator delete[](void* p) noexcept { std::free(p); }
+void  operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void  operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+/* -----------------------------------------------------------
+   Cache-miss counter for the calling thread, via perf_event_open.
+----------------------------------------------------------------*/
+class CacheMissCounter {
+public:
+    CacheMissCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool          available() const { return fd >= 0; }
+    std::uint64_t read() const {
+        std::uint64_t v = 0;
+#ifdef __linux__
+        if (fd >= 0 && ::read(fd, &v, sizeof(v)) != sizeof(v)) v = 0;
+#endif
+        return v;
+    }
+
+private:
+    int fd;
+};
+
+/*
+ Meter – accumulates time, allocations and cache misses over the measured
+  windows of one benchmark run and turns them into per-op counters.
+ */
+class Meter {
+public:
+    void begin() {
+        allocs0 = g_allocations;
+        misses0 = misses.read();
+        t0      = std::chrono::steady_clock::now();
+    }
+    void end() {
+        auto t1 = std::chrono::steady_clock::now();
+        ns     += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        allocs += g_allocations - allocs0;
+        miss   += misses.read() - misses0;
+    }
+    void report(benchmark::State& state, double ops) {
+        if (ops <= 0) return;
+        state.SetItemsProcessed(static_cast<std::int64_t>(ops));
+        state.counters["ns/op"]     = ns / ops;
+        state.counters["allocs/op"] = double(allocs) / ops;
+        if (misses.available()) state.counters["cache-misses/op"] = double(miss) / ops;
+    }
+
+private:
+    CacheMissCounter                      misses;
+    std::chrono::steady_clock::time_point t0;
+    std::size_t                           allocs0 = 0, allocs = 0;
+    std::uint64_t                         misses0 = 0, miss = 0;
+    double                                ns = 0;
+};
+
+/* -----------------------------------------------------------
+   Containers under test and the few adapters they need.
+----------------------------------------------------------------*/
+using PoolList     = DoublyLinkedList<int>;
+using HeapList     = DoublyLinkedList<int, HeapAllocator<Node<int>>>;
+using XorInts      = XorLinkedList<int>;
+using SkipInts     = SkipIndexedList<int>;
+using UnrolledInts = UnrolledList<int>;
+using IndexInts    = IndexList<int>;
+using StdList      = std::list<int>;
+using StdDeque     = std::deque<int>;
+
+template <typename C>
+long sum_of(const C& c) {
+    long s = 0;
+    for (int v : c) s += v;
+    return s;
+}
+long sum_of(const UnrolledInts& c) {
+    long s = 0;
+    c.for_each([&s](int v) { s += v; });
+    return s;
+}
+long sum_of(const IndexInts& c) {
+    long s = 0;
+    for (IndexInts::handle h = c.front_handle(); h != IndexInts::npos; h = c.next(h)) s += c[h];
+    return s;
+}
+
+template <typename C>
+void fill(C& c, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) c.push_back(static_cast<int>(i));
+}
+
+/* -----------------------------------------------------------
+   Push n at one end, pop n at the other (queue order).
+----------------------------------------------------------------*/
+template <typename C>
+static void BM_PushBackPopFront(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    C           c;
+    Meter       m;
+    double      ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        for (std::size_t i = 0; i < n; ++i) c.push_back(static_cast<int>(i));
+        for (std::size_t i = 0; i < n; ++i) c.pop_front();
+        m.end();
+        benchmark::ClobberMemory();
+        ops += 2.0 * double(n);
+    }
+    m.report(state, ops);
+}
+
+// Push n at the front, pop n from the back.
+template <typename C>
+static void BM_PushFrontPopBack(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    C           c;
+    Meter       m;
+    double      ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        for (std::size_t i = 0; i < n; ++i) c.push_front(static_cast<int>(i));
+        for (std::size_t i = 0; i < n; ++i) c.pop_back();
+        m.end();
+        benchmark::ClobberMemory();
+        ops += 2.0 * double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Full forward traversal, summing every element.
+----------------------------------------------------------------*/
+template <typename C>
+static void BM_Traverse(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    C           c;
+    fill(c, n);
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        benchmark::DoNotOptimize(sum_of(c));
+        m.end();
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Splice a whole n-element list onto another and back again.
+----------------------------------------------------------------*/
+static void splice_all(PoolList& to, PoolList& from) { to.splice_back(from); }
+static void splice_all(StdList& to, StdList& from)   { to.splice(to.end(), from); }
+
+template <typename C>
+static void BM_SpliceAll(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    C           a, b;
+    fill(a, n);
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        splice_all(b, a);
+        splice_all(a, b);
+        m.end();
+        ops += 2;
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Erase every element in random order through saved iterators
+   (handles for IndexList). Rebuilding between rounds is not timed.
+----------------------------------------------------------------*/
+template <typename C>
+static std::vector<typename C::iterator> positions_of(C& c) {
+    std::vector<typename C::iterator> its;
+    for (auto it = c.begin(); it != c.end(); ++it) its.push_back(it);
+    return its;
+}
+
+template <typename C>
+static void BM_RandomErase(benchmark::State& state) {
+    std::size_t  n = static_cast<std::size_t>(state.range(0));
+    std::mt19937 rng(42);
+    Meter        m;
+    double       ops = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c;
+        fill(c, n);
+        auto its = positions_of(c);
+        std::shuffle(its.begin(), its.end(), rng);
+        state.ResumeTiming();
+
+        m.begin();
+        for (auto& it : its) c.erase(it);
+        m.end();
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+static void BM_RandomErase_IndexList(benchmark::State& state) {
+    std::size_t  n = static_cast<std::size_t>(state.range(0));
+    std::mt19937 rng(42);
+    Meter        m;
+    double       ops = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        IndexInts c;
+        std::vector<IndexInts::handle> hs;
+        for (std::size_t i = 0; i < n; ++i) hs.push_back(c.push_back(static_cast<int>(i)));
+        std::shuffle(hs.begin(), hs.end(), rng);
+        state.ResumeTiming();
+
+        m.begin();
+        for (IndexInts::handle h : hs) c.erase(h);
+        m.end();
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   1000 reads of random positions in a list of range(0) ints:
+   SkipIndexedList::at against walking a plain list from the front.
+----------------------------------------------------------------*/
+static int value_at(SkipInts& c, std::size_t k) { return c.at(k); }
+static int value_at(PoolList& c, std::size_t k) { return *std::next(c.begin(), static_cast<long>(k)); }
+
+template <typename C>
+static void BM_RandomAt(benchmark::State& state) {
+    std::size_t  n = static_cast<std::size_t>(state.range(0));
+    std::mt19937 rng(42);
+    C            c;
+    fill(c, n);
+    std::vector<std::size_t> ks(1000);
+    for (std::size_t& k : ks) k = rng() % n;
+    Meter  m;
+    double ops = 0;
+    long   sum = 0;
+    for (auto _ : state) {
+        m.begin();
+        for (std::size_t k : ks) sum += value_at(c, k);
+        m.end();
+        ops += double(ks.size());
+    }
+    benchmark::DoNotOptimize(sum);
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Sort range(0) shuffled ints. The pool list and std::list relink
+   nodes; IndexList relinks slots; std::vector is the contiguous
+   baseline. Refilling between rounds is not timed.
+----------------------------------------------------------------*/
+template <typename C> static void sort_all(C& c) { c.sort(); }
+static void sort_all(std::vector<int>& v)        { std::sort(v.begin(), v.end()); }
+
+template <typename C>
+static void BM_Sort(benchmark::State& state) {
+    std::size_t      n = static_cast<std::size_t>(state.range(0));
+    std::vector<int> keys(n);
+    std::mt19937     rng(42);
+    for (int& k : keys) k = static_cast<int>(rng());
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c;
+        for (int k : keys) c.push_back(k);
+        state.ResumeTiming();
+
+        m.begin();
+        sort_all(c);
+        m.end();
+        benchmark::DoNotOptimize(c);
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Sum a list of range(0) ints whose nodes sorting has scattered
+   across the pool, the state a list is in after heavy churn:
+   plainly, through the prefetching for_each, and after relayout()
+   has put the nodes back in list order.
+----------------------------------------------------------------*/
+enum class Scan { plain, prefetch, relayout };
+
+template <Scan S>
+static void BM_ScatteredScan(benchmark::State& state) {
+    std::size_t  n = static_cast<std::size_t>(state.range(0));
+    std::mt19937 rng(42);
+    PoolList     list;
+    for (std::size_t i = 0; i < n; ++i) list.push_back(static_cast<int>(rng()));
+    list.sort();
+    if (S == Scan::relayout) list.relayout();
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        std::int64_t sum = 0;
+        m.begin();
+        if (S == Scan::prefetch) list.for_each([&sum](int v) { sum += v; });
+        else                     for (int v : list) sum += v;
+        m.end();
+        benchmark::DoNotOptimize(sum);
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   A writer keeps a range(0)-element queue turning over and hands
+   a reader a consistent view every 64 writes: an O(1) snapshot of a
+   PersistentList, or a deep copy of a DoublyLinkedList, the only
+   way to get one there. ns/op is per write, view cost included.
+----------------------------------------------------------------*/
+using PersistentInts = PersistentList<int>;
+
+static PersistentInts::Snapshot take_view(const PersistentInts& l) { return l.snapshot(); }
+static PoolList                 take_view(const PoolList& l)       { return PoolList(l.begin(), l.end()); }
+
+template <typename L>
+static void BM_SnapshotChurn(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    L           list;
+    for (std::size_t i = 0; i < n; ++i) list.push_back(static_cast<int>(i));
+    Meter  m;
+    double ops = 0;
+    int    next = static_cast<int>(n);
+    for (auto _ : state) {
+        m.begin();
+        auto view = take_view(list);
+        for (int i = 0; i < 64; ++i) {
+            list.push_back(next++);
+            benchmark::DoNotOptimize(list.pop_front());
+        }
+        m.end();
+        benchmark::DoNotOptimize(view);
+        ops += 64;
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   One producer thread hands 1e5 ints to the benchmark thread
+   through a BatchChannel publishing every range(0) pushes; batch 1
+   is the lock-per-element baseline. Nodes are allocated on the
+   producer and freed on the consumer: HeapNodes leaves that to
+   malloc, NumaNodes to a NumaNodePool placing them on the
+   consumer's node.
+----------------------------------------------------------------*/
+struct HeapNodes {
+    using allocator = HeapAllocator<Node<int>>;
+    allocator get() { return {}; }
+};
+struct NumaNodes {
+    using allocator = NumaPoolAllocator<Node<int>>;
+    NumaNodePool<Node<int>> pool;
+    allocator get() { return allocator(pool, static_cast<int>(dll_numa::current_node())); }
+};
+
+template <typename Nodes>
+static void BM_ChannelHandoff(benchmark::State& state) {
+    const std::size_t batch = static_cast<std::size_t>(state.range(0));
+    const long        n     = 100000;
+    Nodes             nodes;
+    Meter             m;
+    double            ops = 0;
+    for (auto _ : state) {
+        BatchChannel<int, typename Nodes::allocator> ch(batch, std::chrono::milliseconds(1), nodes.get());
+        m.begin();
+        std::thread producer([&] {
+            auto p = ch.producer();
+            for (long i = 0; i < n; ++i) p.push(static_cast<int>(i));
+        });
+        long got = 0, sum = 0;
+        while (got < n) {
+            auto part = ch.take_all();
+            got += static_cast<long>(part.size());
+            sum += sum_of(part);
+        }
+        producer.join();
+        m.end();
+        benchmark::DoNotOptimize(sum);
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Many short-lived short lists: build one of range(0) elements,
+   drain it, drop it. SmallInts keeps up to 8 nodes inline.
+----------------------------------------------------------------*/
+using SmallInts = SmallDoublyLinkedList<int, 8>;
+
+template <typename C>
+static void BM_ShortLists(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    Meter       m;
+    double      ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        for (int rep = 0; rep < 1000; ++rep) {
+            C c;
+            for (std::size_t i = 0; i < n; ++i) c.push_back(static_cast<int>(i));
+            benchmark::DoNotOptimize(sum_of(c));
+        }
+        m.end();
+        ops += 1000.0 * double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Parallel sum on every hardware thread; compare with BM_Traverse.
+   PoolList reuses one partition() across rounds, as a repeated
+   scan of an unchanging list would.
+----------------------------------------------------------------*/
+template <typename C>
+static void BM_ParallelSum(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    C           c;
+    fill(c, n);
+    auto   add = [](long a, long b) { return a + b; };
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        benchmark::DoNotOptimize(c.parallel_reduce(0L, add, add));
+        m.end();
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+static void BM_ParallelSum_Partitioned(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    PoolList    c;
+    fill(c, n);
+    auto   cuts = c.partition(dll_parallel::part_count(n, 0));
+    auto   add  = [](long a, long b) { return a + b; };
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        benchmark::DoNotOptimize(c.parallel_reduce(cuts, 0L, add, add));
+        m.end();
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   Filtered sum (sum of positives) over an UnrolledList<int> with
+   each dll_simd kernel set, against the same loop on PoolList.
+----------------------------------------------------------------*/
+template <dll_simd::Isa I>
+static void BM_SumPositive_Unrolled(benchmark::State& state) {
+    if (!dll_simd::select(I)) {
+        state.SkipWithError("ISA not supported on this CPU");
+        return;
+    }
+    std::size_t  n = static_cast<std::size_t>(state.range(0));
+    UnrolledInts c;
+    for (std::size_t i = 0; i < n; ++i) c.push_back(static_cast<int>(i % 2001) - 1000);
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        benchmark::DoNotOptimize(c.sum_positive());
+        m.end();
+        ops += double(n);
+    }
+    m.report(state, ops);
+    dll_simd::select(dll_simd::best());
+}
+
+static void BM_SumPositive_PoolList(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    PoolList    c;
+    for (std::size_t i = 0; i < n; ++i) c.push_back(static_cast<int>(i % 2001) - 1000);
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        long s = 0;
+        for (int v : c) s += v > 0 ? v : 0;
+        benchmark::DoNotOptimize(s);
+        m.end();
+        ops += double(n);
+    }
+    m.report(state, ops);
+}
+
+/* -----------------------------------------------------------
+   LRU cache of n entries under a mixed get/put stream whose keys
+   span 2n, so roughly half the lookups miss and evict.
+----------------------------------------------------------------*/
+class StdLru {
+public:
+    explicit StdLru(std::size_t capacity) : cap(capacity) {}
+    int* get(int key) {
+        auto it = index.find(key);
+        if (it == index.end()) return nullptr;
+        order.splice(order.begin(), order, it->second);
+        return &it->second->second;
+    }
+    void put(int key, int value) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = value;
+            order.splice(order.begin(), order, it->second);
+            return;
+        }
+        if (order.size() == cap) {
+            index.erase(order.back().first);
+            order.pop_back();
+        }
+        order.emplace_front(key, value);
+        index[key] = order.begin();
+    }
+
+private:
+    std::size_t                                                   cap;
+    std::list<std::pair<int, int>>                                order;
+    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> index;
+};
+
+template <typename Cache>
+static void BM_LruMixed(benchmark::State& state) {
+    std::size_t      n = static_cast<std::size_t>(state.range(0));
+    Cache            cache(n);
+    std::mt19937     rng(42);
+    std::vector<int> keys(1 << 16);
+    for (int& k : keys) k = static_cast<int>(rng() % (2 * n));
+    for (std::size_t i = 0; i < n; ++i) cache.put(static_cast<int>(i), 0);
+    Meter  m;
+    double ops = 0;
+    for (auto _ : state) {
+        m.begin();
+        for (int k : keys)
+            if (!cache.get(k)) cache.put(k, k);
+        m.end();
+        ops += double(keys.size());
+    }
+    m.report(state, ops);
+}
+
+#define DLL_SIZES ->RangeMultiplier(100)->Range(100, DLL_BENCH_MAX_N)->Unit(benchmark::kMillisecond)
+
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, PoolList)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, HeapList)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, XorInts)      DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, SkipInts)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, UnrolledInts) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, IndexInts)    DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, StdList)      DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBackPopFront, StdDeque)     DLL_SIZES;
+
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, PoolList)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, HeapList)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, XorInts)      DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, SkipInts)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, UnrolledInts) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, IndexInts)    DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, StdList)      DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_PushFrontPopBack, StdDeque)     DLL_SIZES;
+
+BENCHMARK_TEMPLATE(BM_Traverse, PoolList)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Traverse, HeapList)     DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Traverse, XorInts)      DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Traverse, UnrolledInts) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Traverse, IndexInts)    DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Traverse, StdList)      DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Traverse, StdDeque)     DLL_SIZES;
+
+BENCHMARK_TEMPLATE(BM_SpliceAll, PoolList) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_SpliceAll, StdList)  DLL_SIZES;
+
+BENCHMARK_TEMPLATE(BM_RandomErase, PoolList) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_RandomErase, HeapList) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_RandomErase, StdList)  DLL_SIZES;
+BENCHMARK(BM_RandomErase_IndexList)          DLL_SIZES;
+
+BENCHMARK_TEMPLATE(BM_RandomAt, SkipInts) ->RangeMultiplier(100)->Range(100, 1000000);
+BENCHMARK_TEMPLATE(BM_RandomAt, PoolList) ->RangeMultiplier(100)->Range(100, 1000000);
+
+BENCHMARK_TEMPLATE(BM_ScatteredScan, Scan::plain)    ->RangeMultiplier(100)->Range(1000, 10000000);
+BENCHMARK_TEMPLATE(BM_ScatteredScan, Scan::prefetch) ->RangeMultiplier(100)->Range(1000, 10000000);
+BENCHMARK_TEMPLATE(BM_ScatteredScan, Scan::relayout) ->RangeMultiplier(100)->Range(1000, 10000000);
+
+BENCHMARK_TEMPLATE(BM_SnapshotChurn, PersistentInts) ->RangeMultiplier(100)->Range(100, 1000000);
+BENCHMARK_TEMPLATE(BM_SnapshotChurn, PoolList)       ->RangeMultiplier(100)->Range(100, 1000000);
+
+BENCHMARK_TEMPLATE(BM_Sort, PoolList)         DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Sort, IndexInts)        DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Sort, StdList)          DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_Sort, std::vector<int>) DLL_SIZES;
+
+BENCHMARK_TEMPLATE(BM_ChannelHandoff, HeapNodes)->Arg(1)->Arg(16)->Arg(256)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ChannelHandoff, NumaNodes)->Arg(1)->Arg(16)->Arg(256)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ShortLists, PoolList)  ->Arg(4)->Arg(8)->Arg(16);
+BENCHMARK_TEMPLATE(BM_ShortLists, SmallInts) ->Arg(4)->Arg(8)->Arg(16);
+BENCHMARK_TEMPLATE(BM_ShortLists, StdList)   ->Arg(4)->Arg(8)->Arg(16);
+
+BENCHMARK_TEMPLATE(BM_ParallelSum, PoolList)     DLL_SIZES->UseRealTime();
+BENCHMARK(BM_ParallelSum_Partitioned)            DLL_SIZES->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelSum, UnrolledInts) DLL_SIZES->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelSum, IndexInts)    DLL_SIZES->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_SumPositive_Unrolled, dll_simd::Isa::scalar) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_SumPositive_Unrolled, dll_simd::Isa::avx2)   DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_SumPositive_Unrolled, dll_simd::Isa::avx512) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_SumPositive_Unrolled, dll_simd::Isa::neon)   DLL_SIZES;
+BENCHMARK(BM_SumPositive_PoolList)                                 DLL_SIZES;
+
+BENCHMARK_TEMPLATE(BM_LruMixed, LruCache<int, int>) DLL_SIZES;
+BENCHMARK_TEMPLATE(BM_LruMixed, StdLru)             DLL_SIZES;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,570 @@
+/*
+ dll_check – allocation checks and a differential fuzzer for the list
+  variants, so later performance work cannot quietly bring back a per-op
+  `new` or a lost element.
+
+     dll_check [rounds [seed]]
+
+ Allocation checks: a counting global operator new, and one budget per
+  operation on a warmed-up container (zero for push/pop on a warm pool,
+  for moves, splices and sorts); going over the budget is a failure.
+ Fuzzing: rounds of random push and pop sequences against std::deque for
+  every two-ended variant (ints and heap-owning strings), snapshots of a
+  PersistentList checked against copies of the deque they saw, and
+  multi-threaded runs of the concurrent containers checking that every
+  element comes out exactly once, in order per producer where promised.
+
+ It is not wired into ctest; run it from sanitizer builds too:
+  -DDLL_SANITIZE=address (ASan + UBSan) or -DDLL_SANITIZE=thread (TSan).
+  Exits non-zero if anything failed.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doubly_linked_list.hpp"
+
+/* -----------------------------------------------------------
+   Allocation counting: every global operator new bumps a counter.
+----------------------------------------------------------------*/
+static std::atomic<std::size_t> g_allocations{0};
+
+void* operator new(std::size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, std::align_val_t a) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(a);
+    if (void* p = std::aligned_alloc(align, (n + align - 1) / align * align)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void* operator new[](std::size_t n, std::align_val_t a) { return ::operator new(n, a); }
+void  operator delete(void* p) noexcept { std::free(p); }
+void  operator delete[](void* p) noexcept { std::free(p); }
+void  operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void  operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void  operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void  operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void  operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void  operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+static int failures = 0;
+
+static void fail(const char* what, const char* detail, std::uint64_t seed) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %llu)\n", what, detail, static_cast<unsigned long long>(seed));
+    ++failures;
+}
+
+/* -----------------------------------------------------------
+   Allocation budgets. Each check warms its container up first, so
+   only the steady state is counted.
+----------------------------------------------------------------*/
+template <typename F>
+static void expect_allocs(const char* what, std::size_t budget, F f) {
+    std::size_t before = g_allocations.load(std::memory_order_relaxed);
+    f();
+    std::size_t got = g_allocations.load(std::memory_order_relaxed) - before;
+    if (got > budget) {
+        std::fprintf(stderr, "FAIL %s: %zu allocations, budget %zu\n", what, got, budget);
+        ++failures;
+    } else {
+        std::printf("ok   %-44s %zu allocation(s)\n", what, got);
+    }
+}
+
+constexpr int warm_n = 1000;
+
+// Fill to warm_n and drain again, leaving every node on the free list.
+template <typename L>
+static void warm(L& l) {
+    for (int i = 0; i < warm_n; ++i) l.push_back(i);
+    while (!l.empty()) l.pop_back();
+}
+
+template <typename L>
+static void check_push_pop(const char* what, L& l) {
+    warm(l);
+    expect_allocs(what, 0, [&] {
+        for (int i = 0; i < warm_n; ++i) (i & 1) ? l.push_back(i) : l.push_front(i);
+        for (int i = 0; i < warm_n; ++i) (i & 1) ? (void)l.pop_back() : (void)l.pop_front();
+    });
+}
+
+static void allocation_checks() {
+    std::printf("allocation checks\n");
+
+    DoublyLinkedList<int> pool;
+    check_push_pop("DoublyLinkedList push/pop, warm pool", pool);
+    UnrolledList<int, 8> unrolled;
+    check_push_pop("UnrolledList push/pop, warm pool", unrolled);
+    XorLinkedList<int> xored;
+    check_push_pop("XorLinkedList push/pop, warm pool", xored);
+    IndexList<int> indexed;
+    check_push_pop("IndexList push/pop, warm slots", indexed);
+    NumaNodePool<Node<int>>                                  arena;
+    DoublyLinkedList<int, NumaPoolAllocator<Node<int>>> numa{NumaPoolAllocator<Node<int>>(arena)};
+    check_push_pop("NumaPoolAllocator push/pop, warm caches", numa);
+
+    SmallDoublyLinkedList<int, 8> small;
+    expect_allocs("SmallDoublyLinkedList<8> 8 pushes, cold", 0, [&] {
+        for (int i = 0; i < 8; ++i) small.push_back(i);
+    });
+
+    for (int i = 0; i < warm_n; ++i) pool.push_back(warm_n - i);
+    expect_allocs("DoublyLinkedList insert/erase mid-list", 0, [&] {
+        auto mid = std::next(pool.begin(), warm_n / 2);
+        for (int i = 0; i < 100; ++i) mid = pool.erase(pool.insert(mid, i));
+    });
+    expect_allocs("DoublyLinkedList move construct + assign", 0, [&] {
+        DoublyLinkedList<int> moved(std::move(pool));
+        pool = std::move(moved);
+    });
+    expect_allocs("DoublyLinkedList sort/unique/insert_sorted", 0, [&] {
+        pool.sort();
+        pool.unique();
+        pool.insert_sorted(42);
+    });
+    expect_allocs("DoublyLinkedList split_at + splice back", 0, [&] {
+        DoublyLinkedList<int> rest = pool.split_at(pool.size() / 3);
+        pool.splice_back(rest);
+    });
+    DoublyLinkedList<int> other;
+    warm(other);
+    for (int i = 0; i < warm_n; ++i) other.push_back(i);
+    expect_allocs("DoublyLinkedList splice across pools", 0, [&] { pool.splice_front(other); });
+    expect_allocs("DoublyLinkedList relayout (one run)", 1, [&] { pool.relayout(); });
+
+    PersistentList<int, 16> persistent;
+    warm(persistent);
+    expect_allocs("PersistentList queue churn, warm", 0, [&] {
+        for (int i = 0; i < warm_n; ++i) {
+            persistent.push_back(i);
+            persistent.pop_front();
+        }
+    });
+    for (int i = 0; i < warm_n; ++i) persistent.push_back(i);
+    expect_allocs("PersistentList snapshot", 0, [&] {
+        auto view = persistent.snapshot();
+        auto copy = view;
+        (void)copy;
+    });
+}
+
+/* -----------------------------------------------------------
+   Differential fuzzing against std::deque.
+----------------------------------------------------------------*/
+template <typename V> V make_value(std::uint64_t r);
+template <> int make_value<int>(std::uint64_t r) { return static_cast<int>(r); }
+// Long enough to defeat the small-string buffer, so lifetimes hit the heap.
+template <> std::string make_value<std::string>(std::uint64_t r) {
+    return std::to_string(r) + "-padding-past-small-string";
+}
+
+// contents – the elements in list order, by whichever walk L offers.
+template <typename L>
+static auto contents(const L& l, int) -> decltype(l.begin(), std::vector<typename L::value_type>()) {
+    std::vector<typename L::value_type> out;
+    for (const auto& v : l) out.push_back(v);
+    return out;
+}
+template <typename L>
+static auto contents(const L& l, long) -> decltype(l.front_handle(), std::vector<typename L::value_type>()) {
+    std::vector<typename L::value_type> out;
+    for (auto h = l.front_handle(); h != L::npos; h = l.next(h)) out.push_back(l[h]);
+    return out;
+}
+template <typename L>
+static std::vector<typename L::value_type> contents(const L& l, ...) {
+    std::vector<typename L::value_type> out;
+    l.for_each([&out](const typename L::value_type& v) { out.push_back(v); });
+    return out;
+}
+
+template <typename L, typename Make>
+static void fuzz_two_ended(const char* what, std::uint64_t seed, std::size_t steps, Make make) {
+    using V = typename L::value_type;
+    std::mt19937_64 rng(seed);
+    L               l = make();
+    std::deque<V>   ref;
+    for (std::size_t step = 0; step < steps; ++step) {
+        std::uint64_t r = rng();
+        switch (r % 16) {
+        case 0: case 1: case 2: case 3:
+            l.push_back(make_value<V>(r >> 8));
+            ref.push_back(make_value<V>(r >> 8));
+            break;
+        case 4: case 5: case 6:
+            l.push_front(make_value<V>(r >> 8));
+            ref.push_front(make_value<V>(r >> 8));
+            break;
+        case 7: case 8: case 9:
+            if (ref.empty()) break;
+            if (l.pop_front() != ref.front()) return fail(what, "pop_front value", seed);
+            ref.pop_front();
+            break;
+        case 10: case 11: case 12:
+            if (ref.empty()) break;
+            if (l.pop_back() != ref.back()) return fail(what, "pop_back value", seed);
+            ref.pop_back();
+            break;
+        case 13:
+            if (ref.empty()) break;
+            if (l.front() != ref.front() || l.back() != ref.back()) return fail(what, "front/back", seed);
+            // Pushing a copy of an element the list holds, which must survive
+            // the push growing or reshaping the storage it lives in.
+            if (r & 256) {
+                l.push_back(l.front());
+                ref.push_back(ref.front());
+            } else {
+                l.push_front(l.back());
+                ref.push_front(ref.back());
+            }
+            break;
+        case 14:
+            if (ref.empty()) {
+                bool threw = false;
+                try {
+                    (r & 256) ? (void)l.pop_front() : (void)l.pop_back();
+                } catch (const std::underflow_error&) {
+                    threw = true;
+                }
+                if (!threw) return fail(what, "pop on empty did not throw underflow_error", seed);
+            } else if (r % 97 == 0) {
+                L moved(std::move(l));
+                l = std::move(moved);
+            }
+            break;
+        default:
+            if (r % 64 == 0 && contents(l, 0) != std::vector<V>(ref.begin(), ref.end()))
+                return fail(what, "contents", seed);
+        }
+        if (l.size() != ref.size()) return fail(what, "size", seed);
+    }
+    if (contents(l, 0) != std::vector<V>(ref.begin(), ref.end())) fail(what, "final contents", seed);
+}
+
+template <typename L>
+static void fuzz_two_ended(const char* what, std::uint64_t seed, std::size_t steps) {
+    fuzz_two_ended<L>(what, seed, steps, [] { return L(); });
+}
+
+// Snapshots must keep showing exactly what the list held when taken.
+template <typename V>
+static void fuzz_snapshots(const char* what, std::uint64_t seed, std::size_t steps) {
+    using L = PersistentList<V, 4>;
+    std::mt19937_64                                         rng(seed);
+    L                                                       l;
+    std::deque<V>                                           ref;
+    std::vector<std::pair<typename L::Snapshot, std::deque<V>>> views;
+    for (std::size_t step = 0; step < steps; ++step) {
+        std::uint64_t r = rng();
+        switch (r % 12) {
+        case 0: case 1: case 2:
+            l.push_back(make_value<V>(r >> 8));
+            ref.push_back(make_value<V>(r >> 8));
+            break;
+        case 3: case 4:
+            l.push_front(make_value<V>(r >> 8));
+            ref.push_front(make_value<V>(r >> 8));
+            break;
+        case 5: case 6:
+            if (ref.empty()) break;
+            if (l.pop_front() != ref.front()) return fail(what, "pop_front value", seed);
+            ref.pop_front();
+            break;
+        case 7: case 8:
+            if (ref.empty()) break;
+            if (l.pop_back() != ref.back()) return fail(what, "pop_back value", seed);
+            ref.pop_back();
+            break;
+        case 9:
+            views.emplace_back(l.snapshot(), ref);
+            if (views.size() > 4) views.erase(views.begin() + static_cast<std::ptrdiff_t>((r >> 8) % views.size()));
+            break;
+        default:
+            for (auto& view : views)
+                if (contents(view.first, 0) != std::vector<V>(view.second.begin(), view.second.end()))
+                    return fail(what, "snapshot changed under writes", seed);
+        }
+    }
+    if (contents(l, 0) != std::vector<V>(ref.begin(), ref.end())) fail(what, "final contents", seed);
+}
+
+/* -----------------------------------------------------------
+   Concurrent containers: every element out exactly once.
+----------------------------------------------------------------*/
+constexpr int threads_n = 4;
+
+static void fuzz_concurrent_deque(std::uint64_t seed, int per_thread) {
+    ConcurrentDeque<int>           q;
+    std::vector<std::atomic<int>>  seen(static_cast<std::size_t>(threads_n * per_thread));
+    std::atomic<int>               taken{0};
+    std::vector<std::thread>       pool;
+    for (int t = 0; t < threads_n; ++t) {
+        pool.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(seed) + static_cast<unsigned>(t));
+            for (int i = 0; i < per_thread; ++i) {
+                int v = t * per_thread + i;
+                (rng() & 1) ? q.push_back(v) : q.push_front(v);
+                if (std::optional<int> got = (rng() & 1) ? q.pop_front() : q.pop_back()) {
+                    seen[static_cast<std::size_t>(*got)].fetch_add(1, std::memory_order_relaxed);
+                    taken.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (std::thread& t : pool) t.join();
+    while (std::optional<int> got = q.pop_front()) {
+        seen[static_cast<std::size_t>(*got)].fetch_add(1, std::memory_order_relaxed);
+        taken.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (auto& s : seen)
+        if (s.load() != 1) return fail("ConcurrentDeque", "element lost or duplicated", seed);
+}
+
+// More threads alive at once than one block of epoch records, in two waves
+// so the second reuses the records the first gave back on exit.
+static void fuzz_concurrent_deque_crowd(std::uint64_t seed) {
+    constexpr int                 crowd = 200, per_thread = 8;
+    ConcurrentDeque<int>          q;
+    std::vector<std::atomic<int>> seen(static_cast<std::size_t>(2 * crowd * per_thread));
+    std::atomic<bool>             threw{false};
+    for (int wave = 0; wave < 2; ++wave) {
+        std::atomic<int>         arrived{0};
+        std::vector<std::thread> pool;
+        for (int t = 0; t < crowd; ++t)
+            pool.emplace_back([&, t] {
+                try {
+                    int base = (wave * crowd + t) * per_thread;
+                    for (int i = 0; i < per_thread; ++i) q.push_back(base + i);
+                    arrived.fetch_add(1);
+                    while (arrived.load() < crowd) std::this_thread::yield();
+                    for (int i = 0; i < per_thread; ++i)
+                        if (std::optional<int> got = q.pop_front())
+                            seen[static_cast<std::size_t>(*got)].fetch_add(1, std::memory_order_relaxed);
+                } catch (...) {
+                    threw.store(true);
+                    arrived.fetch_add(1);
+                }
+            });
+        for (std::thread& t : pool) t.join();
+    }
+    while (std::optional<int> got = q.pop_front()) seen[static_cast<std::size_t>(*got)].fetch_add(1);
+    if (threw.load()) return fail("ConcurrentDeque crowd", "operation threw", seed);
+    for (auto& s : seen)
+        if (s.load() != 1) return fail("ConcurrentDeque crowd", "element lost or duplicated", seed);
+}
+
+// More threads than NumaNodePool has caches, each filling and draining its
+// own list on one shared pool, in two waves so exited threads' caches are
+// reused.
+static void fuzz_numa_crowd(std::uint64_t seed, NumaNodePool<Node<int>>& arena) {
+    using NumaList = DoublyLinkedList<int, NumaPoolAllocator<Node<int>>>;
+    constexpr int     crowd = 200, per_thread = 100;
+    std::atomic<bool> broken{false};
+    for (int wave = 0; wave < 2; ++wave) {
+        std::atomic<int>         arrived{0};
+        std::vector<std::thread> pool;
+        for (int t = 0; t < crowd; ++t)
+            pool.emplace_back([&, t] {
+                try {
+                    NumaList l{NumaPoolAllocator<Node<int>>(arena)};
+                    for (int i = 0; i < per_thread; ++i) l.push_back(t + i);
+                    arrived.fetch_add(1);
+                    while (arrived.load() < crowd) std::this_thread::yield();
+                    for (int i = 0; i < per_thread; ++i)
+                        if (l.pop_front() != t + i) broken.store(true);
+                } catch (...) {
+                    broken.store(true);
+                    arrived.fetch_add(1);
+                }
+            });
+        for (std::thread& t : pool) t.join();
+    }
+    if (broken.load()) fail("NumaNodePool crowd", "allocation threw or list corrupted", seed);
+}
+
+static void fuzz_work_stealing(std::uint64_t seed, int total) {
+    WorkStealingDeque<int>        q;
+    std::vector<std::atomic<int>> seen(static_cast<std::size_t>(total));
+    std::atomic<bool>             done{false};
+    std::vector<std::thread>      thieves;
+    for (int t = 1; t < threads_n; ++t)
+        thieves.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire))
+                if (std::optional<int> got = q.steal())
+                    seen[static_cast<std::size_t>(*got)].fetch_add(1, std::memory_order_relaxed);
+        });
+    std::mt19937 rng(static_cast<unsigned>(seed));
+    for (int i = 0; i < total; ++i) {
+        q.push_back(i);
+        if (rng() % 3 == 0)
+            if (std::optional<int> got = q.pop_back())
+                seen[static_cast<std::size_t>(*got)].fetch_add(1, std::memory_order_relaxed);
+    }
+    while (std::optional<int> got = q.pop_back()) seen[static_cast<std::size_t>(*got)].fetch_add(1, std::memory_order_relaxed);
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : thieves) t.join();
+    for (auto& s : seen)
+        if (s.load() != 1) return fail("WorkStealingDeque", "element lost or duplicated", seed);
+}
+
+// Producers push (thread, i) pairs; each producer's run must arrive in order.
+template <typename Channel>
+static void fuzz_channel(const char* what, std::uint64_t seed, int per_thread, Channel& ch) {
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads_n; ++t)
+        producers.emplace_back([&ch, t, per_thread] {
+            auto p = ch.producer();
+            for (int i = 0; i < per_thread; ++i) p.push(t * per_thread + i);
+        });
+    std::vector<int> next(threads_n, 0);
+    for (int got = 0; got < threads_n * per_thread;) {
+        for (int v : ch.take_all()) {
+            int t = v / per_thread;
+            if (v % per_thread != next[static_cast<std::size_t>(t)]++) {
+                fail(what, "producer order broken", seed);
+                for (std::thread& p : producers) p.join();
+                return;
+            }
+            ++got;
+        }
+    }
+    for (std::thread& p : producers) p.join();
+}
+
+// A producer that stages a few elements and goes quiet: a consumer, blocked
+// or polling, must still get them once they have lingered.
+static void check_channel_linger(std::uint64_t seed) {
+    BatchChannel<int> ch(256, std::chrono::milliseconds(1));
+    std::atomic<int>  stage{0};
+    std::thread       producer([&] {
+        auto p = ch.producer();
+        for (int i = 0; i < 5; ++i) p.push(i);
+        stage.store(1);
+        while (stage.load() != 2) std::this_thread::yield();   // idle, holding the batch
+        for (int i = 5; i < 12; ++i) p.push(i);
+        stage.store(3);
+        while (stage.load() != 4) std::this_thread::yield();
+    });
+    while (stage.load() != 1) std::this_thread::yield();
+    std::size_t got = ch.take_all_for(std::chrono::seconds(5)).size();
+    stage.store(2);
+    while (stage.load() != 3) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    got += ch.try_take_all().size();
+    stage.store(4);
+    producer.join();
+    if (got != 12) fail("BatchChannel linger", "idle producer's batch never published", seed);
+}
+
+// batch == 1 (and batch == 0, clamped to it) publishes every push at once.
+static void check_channel_unbatched(std::uint64_t seed) {
+    for (std::size_t batch : {std::size_t(0), std::size_t(1)}) {
+        BatchChannel<int> ch(batch, std::chrono::hours(1));
+        auto              p = ch.producer();
+        for (int i = 0; i < 3; ++i) {
+            p.push(i);
+            if (p.pending() != 0 || ch.try_take_all().size() != 1)
+                return fail("BatchChannel batch 1", "push not published at once", seed);
+        }
+    }
+}
+
+static void fuzz_persistent_readers(std::uint64_t seed, int writes) {
+    using L = PersistentList<std::string, 8>;
+    L                        l;
+    std::mutex               lock;
+    L::Snapshot              published;
+    std::atomic<bool>        done{false}, broken{false};
+    std::vector<std::thread> readers;
+    for (int t = 1; t < threads_n; ++t)
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                L::Snapshot view;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    view = published;
+                }
+                long expect = view.empty() ? 0 : std::stol(view.front());
+                for (const std::string& s : view)
+                    if (std::stol(s) != expect++) broken.store(true);
+            }
+        });
+    long next = 0;
+    for (int i = 0; i < writes; ++i) {
+        l.push_back(std::to_string(next++));
+        if (l.size() > 256) l.pop_front();
+        if (i % 61 == 0 && l.size() > 1) {
+            l.pop_back();
+            l.push_back(std::to_string(next - 1));
+        }
+        if (i % 50 == 0) {
+            L::Snapshot view = l.snapshot();
+            std::lock_guard<std::mutex> guard(lock);
+            published = std::move(view);
+        }
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : readers) t.join();
+    if (broken.load()) fail("PersistentList readers", "snapshot not consistent", seed);
+}
+
+int main(int argc, char** argv) {
+    int           rounds = argc > 1 ? std::atoi(argv[1]) : 4;
+    std::uint64_t seed   = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    allocation_checks();
+
+    std::printf("fuzzing %d round(s) from seed %llu\n", rounds, static_cast<unsigned long long>(seed));
+    NumaNodePool<Node<int>> arena;
+    using NumaList = DoublyLinkedList<int, NumaPoolAllocator<Node<int>>>;
+    for (int round = 0; round < rounds; ++round, ++seed) {
+        const std::size_t steps = 20000;
+        fuzz_two_ended<DoublyLinkedList<int>>("DoublyLinkedList<int>", seed, steps);
+        fuzz_two_ended<DoublyLinkedList<std::string>>("DoublyLinkedList<string>", seed, steps);
+        fuzz_two_ended<DoublyLinkedList<int, HeapAllocator<Node<int>>>>("DoublyLinkedList<int, Heap>", seed, steps);
+        fuzz_two_ended<SmallDoublyLinkedList<std::string, 4>>("SmallDoublyLinkedList<string, 4>", seed, steps);
+        fuzz_two_ended<NumaList>("DoublyLinkedList<int, NumaPool>", seed, steps,
+                                 [&arena] { return NumaList(NumaPoolAllocator<Node<int>>(arena)); });
+        fuzz_two_ended<UnrolledList<std::string, 3>>("UnrolledList<string, 3>", seed, steps);
+        fuzz_two_ended<XorLinkedList<std::string>>("XorLinkedList<string>", seed, steps);
+        fuzz_two_ended<IndexList<std::string>>("IndexList<string>", seed, steps);
+        fuzz_two_ended<SkipIndexedList<int>>("SkipIndexedList<int>", seed, steps);
+        fuzz_two_ended<PersistentList<std::string, 3>>("PersistentList<string, 3>", seed, steps);
+        fuzz_snapshots<std::string>("PersistentList snapshots", seed, steps);
+
+        fuzz_concurrent_deque(seed, 5000);
+        fuzz_concurrent_deque_crowd(seed);
+        fuzz_work_stealing(seed, 20000);
+        fuzz_numa_crowd(seed, arena);
+        BatchChannel<int> heap_channel(16);
+        fuzz_channel("BatchChannel<int>", seed, 5000, heap_channel);
+        BatchChannel<int, NumaPoolAllocator<Node<int>>> numa_channel(
+            16, std::chrono::milliseconds(1), NumaPoolAllocator<Node<int>>(arena));
+        fuzz_channel("BatchChannel<int, NumaPool>", seed, 5000, numa_channel);
+        check_channel_linger(seed);
+        check_channel_unbatched(seed);
+        fuzz_persistent_readers(seed, 20000);
+        std::printf("round %d done\n", round + 1);
+    }
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
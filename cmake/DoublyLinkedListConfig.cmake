@@ -0,0 +1,5 @@
+# find_package(DoublyLinkedList) – imports dll::dll (header-only) and
+# dll::instances (explicit instantiations for the common element types).
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+include("${CMAKE_CURRENT_LIST_DIR}/DoublyLinkedListTargets.cmake")
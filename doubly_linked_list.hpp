@@ -0,0 +1,7000 @@
+// doubly_linked_list.hpp – DoublyLinkedList and its variants (pool-backed,
+// unrolled, persistent, index-based, lock-free, work-stealing, and under
+// C++20 a coroutine-awaitable deque). Header-only.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define DLL_HAVE_POSIX_WRITE 1
+#endif
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define DLL_HAVE_COROUTINES 1
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define DLL_SIMD_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define DLL_SIMD_NEON 1
+#endif
+
+/*
+ Hot-path statistics for DoublyLinkedList, compiled in only when
+  DLL_ENABLE_STATS is defined to 1. Each thread bumps its own counter block
+  (plain relaxed load/store, no locked instructions); dll_stats::snapshot()
+  sums every live thread plus the totals left behind by exited threads.
+  With stats disabled the hooks expand to nothing and snapshot() is all 0.
+ */
+#ifndef DLL_ENABLE_STATS
+#define DLL_ENABLE_STATS 0
+#endif
+
+namespace dll_stats {
+
+struct Counters {
+    std::uint64_t push_front  = 0;
+    std::uint64_t push_back   = 0;
+    std::uint64_t pop_front   = 0;
+    std::uint64_t pop_back    = 0;
+    std::uint64_t empty_pops  = 0;   // pop_* that threw or try_pop_* that found nothing
+    std::uint64_t node_allocs = 0;
+    std::uint64_t peak_size   = 0;   // largest size() any list reached
+};
+
+#if DLL_ENABLE_STATS
+
+enum Field { push_front, push_back, pop_front, pop_back, empty_pops, node_allocs, field_count };
+
+struct ThreadBlock {
+    std::atomic<std::uint64_t> count[field_count];
+    std::atomic<std::uint64_t> peak;
+
+    ThreadBlock();
+    ~ThreadBlock();
+};
+
+struct Registry {
+    std::mutex                mu;
+    std::vector<ThreadBlock*> live;
+    Counters                  retired;
+};
+
+inline Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+inline void fold(Counters& into, const ThreadBlock& b) {
+    into.push_front  += b.count[push_front].load(std::memory_order_relaxed);
+    into.push_back   += b.count[push_back].load(std::memory_order_relaxed);
+    into.pop_front   += b.count[pop_front].load(std::memory_order_relaxed);
+    into.pop_back    += b.count[pop_back].load(std::memory_order_relaxed);
+    into.empty_pops  += b.count[empty_pops].load(std::memory_order_relaxed);
+    into.node_allocs += b.count[node_allocs].load(std::memory_order_relaxed);
+    std::uint64_t p   = b.peak.load(std::memory_order_relaxed);
+    if (p > into.peak_size) into.peak_size = p;
+}
+
+inline ThreadBlock::ThreadBlock() {
+    for (auto& c : count) c.store(0, std::memory_order_relaxed);
+    peak.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(registry().mu);
+    registry().live.push_back(this);
+}
+
+inline ThreadBlock::~ThreadBlock() {
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    fold(r.retired, *this);
+    r.live.erase(std::find(r.live.begin(), r.live.end(), this));
+}
+
+inline ThreadBlock& local() {
+    thread_local ThreadBlock block;
+    return block;
+}
+
+// Only the owning thread writes its block, so no read-modify-write is needed.
+inline void bump(Field f, std::uint64_t by = 1) {
+    std::atomic<std::uint64_t>& c = local().count[f];
+    c.store(c.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+inline void note_size(std::size_t n) {
+    std::atomic<std::uint64_t>& p = local().peak;
+    if (n > p.load(std::memory_order_relaxed)) p.store(n, std::memory_order_relaxed);
+}
+
+inline Counters snapshot() {
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    Counters                    total = r.retired;
+    for (const ThreadBlock* b : r.live) fold(total, *b);
+    return total;
+}
+
+// Zero every counter. Meant for quiescent points such as between benchmark runs.
+inline void reset() {
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    r.retired = Counters();
+    for (ThreadBlock* b : r.live) {
+        for (auto& c : b->count) c.store(0, std::memory_order_relaxed);
+        b->peak.store(0, std::memory_order_relaxed);
+    }
+}
+
+#define DLL_STAT(field, n)   ::dll_stats::bump(::dll_stats::field, (n))
+#define DLL_STAT_SIZE(n)     ::dll_stats::note_size(n)
+
+#else
+
+inline Counters snapshot() { return Counters(); }
+inline void     reset() {}
+
+#define DLL_STAT(field, n)   ((void)0)
+#define DLL_STAT_SIZE(n)     ((void)0)
+
+#endif
+
+} // namespace dll_stats
+
+/*
+ dll_io – block-buffered element output. Values are formatted into a
+  thread-local 64 KiB buffer (std::to_chars for arithmetic types) and the
+  sink only sees whole blocks, so dumping a list costs one stream or
+  write(2) call per block instead of one per element, and nothing flushes.
+ */
+namespace dll_io {
+
+enum class Direction { forward, backward };
+
+/*
+ Scratch – the calling thread's output blocks, one per live BlockWriter.
+  Writers nest (an element's operator<< may print a list of its own), so
+  each takes the block at the current depth and gives it back on
+  destruction; blocks are kept for reuse.
+ */
+struct Scratch {
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t                          depth = 0;
+};
+
+inline Scratch& scratch() {
+    thread_local Scratch s;
+    return s;
+}
+
+template <typename Sink>
+class BlockWriter {
+public:
+    static constexpr std::size_t block_size = 1 << 16;
+
+    explicit BlockWriter(Sink& s) : sink(s), buf(take_block()), used(0) {}
+    ~BlockWriter() { --scratch().depth; }
+
+    BlockWriter(const BlockWriter&)            = delete;
+    BlockWriter& operator=(const BlockWriter&) = delete;
+
+    void put(const char* s, std::size_t n) {
+        while (n) {
+            if (used == block_size) flush();
+            std::size_t take = block_size - used < n ? block_size - used : n;
+            std::memcpy(buf + used, s, take);
+            used += take;
+            s    += take;
+            n    -= take;
+        }
+    }
+    void put(const char* s) { put(s, std::strlen(s)); }
+
+    template <typename T>
+    void value(const T& v) {
+        if constexpr (std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                      !std::is_same<T, char>::value) {
+            if (block_size - used < max_number_chars) flush();
+            std::to_chars_result r = std::to_chars(buf + used, buf + block_size, v);
+            used = static_cast<std::size_t>(r.ptr - buf);
+        } else {
+            // Anything else goes through its operator<<, on this writer's own
+            // stream, with whatever flags the last value left reset first.
+            if (!fmt) fmt.emplace();
+            else      reset_format();
+            *fmt << v;
+            const std::string& s = fmt->str();
+            put(s.data(), s.size());
+        }
+    }
+
+    void flush() {
+        if (used) sink(static_cast<const char*>(buf), used);
+        used = 0;
+    }
+
+private:
+    static constexpr std::size_t max_number_chars = 64;
+
+    Sink&                             sink;
+    char*                             buf;
+    std::size_t                       used;
+    std::optional<std::ostringstream> fmt;
+
+    static char* take_block() {
+        Scratch& sc = scratch();
+        if (sc.depth == sc.blocks.size()) sc.blocks.emplace_back(new char[block_size]);
+        return sc.blocks[sc.depth++].get();
+    }
+
+    void reset_format() {
+        fmt->str(std::string());
+        fmt->clear();
+        fmt->flags(std::ios_base::dec | std::ios_base::skipws);
+        fmt->precision(6);
+        fmt->width(0);
+        fmt->fill(' ');
+    }
+};
+
+// OstreamSink – hands whole blocks to ostream::write; never flushes.
+struct OstreamSink {
+    std::ostream& os;
+    void operator()(const char* p, std::size_t n) { os.write(p, static_cast<std::streamsize>(n)); }
+};
+
+#if DLL_HAVE_POSIX_WRITE
+// FdSink – write(2) the block, retrying short writes and EINTR.
+struct FdSink {
+    int fd;
+    void operator()(const char* p, std::size_t n) {
+        while (n) {
+            ssize_t w = ::write(fd, p, n);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "dll_io write");
+            }
+            p += w;
+            n -= static_cast<std::size_t>(w);
+        }
+    }
+};
+#endif
+
+/*
+ print_framed – the print_forward/print_backward format ("[head] 1 2 [null]")
+  on std::cout through one BlockWriter, for lists without a write_to of
+  their own. walk(emit) calls emit(value) for each element in order.
+ */
+template <typename Walk>
+void print_framed(Direction dir, Walk walk) {
+    OstreamSink              sink{std::cout};
+    BlockWriter<OstreamSink> w(sink);
+    w.put(dir == Direction::forward ? "[head] " : "[tail] ");
+    walk([&w](const auto& v) {
+        w.value(v);
+        w.put(" ", 1);
+    });
+    w.put("[null]\n", 7);
+    w.flush();
+}
+
+} // namespace dll_io
+
+/*
+ dll_snapshot – binary checkpoint format shared by the list types.
+  A 64-byte header (magic, byte order, element size/kind, counts) is followed
+  at payload_offset by either the values in list order (Layout::values) or
+  IndexList's raw slot array (Layout::index_slots), which can be mapped and
+  used in place. Only trivially copyable element types are supported, and a
+  snapshot is only readable on a machine with the same byte order.
+ */
+namespace dll_snapshot {
+
+enum class Layout : std::uint32_t { values = 1, index_slots = 2 };
+
+struct Header {
+    char          magic[8];        // "DLLSNAP1"
+    std::uint32_t byte_order;      // 0x01020304 as written
+    std::uint32_t layout;
+    std::uint32_t elem_size;
+    std::uint32_t elem_kind;       // see kind_of<T>()
+    std::uint64_t count;           // elements in the list
+    std::uint32_t slot_size;       // index_slots only
+    std::uint32_t used;            // index_slots only: slots stored
+    std::uint32_t head;            // index_slots only
+    std::uint32_t tail;
+    std::uint32_t free_head;
+    std::uint32_t reserved;
+    std::uint64_t payload_offset;  // from the start of the file, 64-aligned
+};
+static_assert(sizeof(Header) == 64, "snapshot header must stay 64 bytes");
+
+constexpr std::uint32_t byte_order_mark = 0x01020304u;
+
+// 1 = signed integer, 2 = unsigned integer, 3 = floating point, 0 = other.
+template <typename T>
+constexpr std::uint32_t kind_of() {
+    return std::is_floating_point<T>::value ? 3
+         : std::is_integral<T>::value       ? (std::is_signed<T>::value ? 1 : 2)
+         : 0;
+}
+
+template <typename T>
+Header make_header(Layout layout, std::uint64_t count) {
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, "DLLSNAP1", 8);
+    h.byte_order     = byte_order_mark;
+    h.layout         = static_cast<std::uint32_t>(layout);
+    h.elem_size      = sizeof(T);
+    h.elem_kind      = kind_of<T>();
+    h.count          = count;
+    h.payload_offset = sizeof(Header);
+    return h;
+}
+
+// check – throw unless h describes a snapshot of T in the given layout.
+template <typename T>
+void check(const Header& h, Layout layout) {
+    if (std::memcmp(h.magic, "DLLSNAP1", 8) != 0)
+        throw std::runtime_error("not a list snapshot");
+    if (h.byte_order != byte_order_mark)
+        throw std::runtime_error("list snapshot has foreign byte order");
+    if (h.layout != static_cast<std::uint32_t>(layout))
+        throw std::runtime_error("list snapshot has a different layout");
+    if (h.elem_size != sizeof(T) || h.elem_kind != kind_of<T>())
+        throw std::runtime_error("list snapshot element type mismatch");
+    if (h.payload_offset < sizeof(Header) || h.payload_offset % alignof(T) != 0)
+        throw std::runtime_error("list snapshot payload offset out of range");
+}
+
+// Stage – aligned raw room for a run of values on their way to or from a
+// stream: up to 64 KiB of them, at least one, on the heap so a large T
+// cannot overflow the stack.
+template <typename T>
+class Stage {
+public:
+    static constexpr std::size_t max_bytes = 64 * 1024;
+
+    explicit Stage(std::uint64_t want)
+        : n(std::size_t(std::max<std::uint64_t>(1, std::min<std::uint64_t>(
+              want, std::max<std::size_t>(1, max_bytes / sizeof(T)))))),
+          p(static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))))) {}
+    ~Stage() { ::operator delete(static_cast<void*>(p), std::align_val_t(alignof(T))); }
+
+    Stage(const Stage&)            = delete;
+    Stage& operator=(const Stage&) = delete;
+
+    T*          data()       { return p; }
+    std::size_t size() const { return n; }
+
+private:
+    std::size_t n;
+    T*          p;
+};
+
+inline void read_exact(std::istream& is, void* p, std::size_t n) {
+    if (!is.read(static_cast<char*>(p), static_cast<std::streamsize>(n)))
+        throw std::runtime_error("truncated list snapshot");
+}
+
+#if DLL_HAVE_POSIX_WRITE
+/*
+ MappedFile – private, writable mapping of a whole snapshot file. Writes
+  stay in this process (copy-on-write), so a mapped list may be modified
+  without touching the file.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const char* path) : base(nullptr), length(0) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int e = errno;
+            ::close(fd);
+            throw std::system_error(e, std::generic_category(), path);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        if (length < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("truncated list snapshot");
+        }
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        int   e = errno;
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::system_error(e, std::generic_category(), path);
+        base = static_cast<char*>(p);
+    }
+    ~MappedFile() { if (base) ::munmap(base, length); }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const Header& header() const { return *reinterpret_cast<const Header*>(base); }
+    char*         data()         { return base; }
+    std::size_t   size() const   { return length; }
+
+    // Payload of count items of item_size bytes, bounds-checked against the file.
+    char* payload(std::uint64_t count, std::size_t item_size) {
+        const Header& h = header();
+        if (h.payload_offset > length || count > (length - h.payload_offset) / item_size)
+            throw std::runtime_error("truncated list snapshot");
+        return base + h.payload_offset;
+    }
+
+private:
+    char*       base;
+    std::size_t length;
+};
+#endif
+
+} // namespace dll_snapshot
+
+/*
+ dll_parallel – thread plumbing shared by the lists' parallel_* scans.
+  Each scan cuts its list into parts, runs one thread per part and combines
+  the per-part results in part order.
+ */
+namespace dll_parallel {
+
+// Parts smaller than this are not worth a thread of their own.
+constexpr std::size_t min_grain = std::size_t(1) << 15;
+
+// part_count – threads for a scan of n elements; requested == 0 means one
+// per hardware thread.
+inline std::size_t part_count(std::size_t n, unsigned requested) {
+    std::size_t threads = requested ? requested : std::max(1u, std::thread::hardware_concurrency());
+    return std::max<std::size_t>(1, std::min(threads, n / min_grain));
+}
+
+/*
+ run – call fn(i) for every part i, part 0 on the calling thread. The first
+  exception any part throws is rethrown once every thread has joined.
+ */
+template <typename Fn>
+void run(std::size_t parts, Fn fn) {
+    std::exception_ptr       error;
+    std::mutex               error_lock;
+    auto                     guarded = [&](std::size_t i) {
+        try {
+            fn(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(error_lock);
+            if (!error) error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(parts ? parts - 1 : 0);
+    for (std::size_t i = 1; i < parts; ++i) pool.emplace_back(guarded, i);
+    if (parts) guarded(0);
+    for (std::thread& t : pool) t.join();
+    if (error) std::rethrow_exception(error);
+}
+
+// combine_all – merge the per-part results left to right.
+template <typename U, typename Combine>
+U combine_all(std::vector<U>& partials, Combine& combine) {
+    U acc = std::move(partials[0]);
+    for (std::size_t i = 1; i < partials.size(); ++i) acc = combine(std::move(acc), std::move(partials[i]));
+    return acc;
+}
+
+} // namespace dll_parallel
+
+/*
+ dll_prefetch – streaming walks over pointer-linked nodes. A Lookahead
+  keeps a second cursor `distance` nodes in front of the current one and
+  prefetches each node it reaches, so by the time the walk arrives there the
+  node is (with luck) already in cache and its load overlaps with the work
+  done on the nodes in between. It helps most on lists whose nodes are
+  scattered in memory; a compacted list is prefetched by the hardware anyway.
+ */
+namespace dll_prefetch {
+
+constexpr std::size_t distance = 8;
+
+inline void touch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#else
+    (void)p;
+#endif
+}
+
+// Lookahead – walk from first along Link (next or prev) until null.
+template <typename NodeT, NodeT* NodeT::*Link>
+class Lookahead {
+public:
+    explicit Lookahead(NodeT* first = nullptr) : cur(first), ahead(first) {
+        for (std::size_t d = 0; ahead && d < distance; ++d) {
+            touch(ahead);
+            ahead = ahead->*Link;
+        }
+    }
+
+    NodeT* get() const { return cur; }
+    void   advance() {
+        cur = cur->*Link;
+        if (ahead) {
+            touch(ahead);
+            ahead = ahead->*Link;
+        }
+    }
+
+private:
+    NodeT* cur;
+    NodeT* ahead;
+};
+
+// Range – what a list's stream() returns, for range-for.
+template <typename It>
+struct Range {
+    It first, last;
+    It begin() const { return first; }
+    It end() const { return last; }
+};
+
+} // namespace dll_prefetch
+
+/*
+ dll_simd – scans over contiguous int32 runs (an UnrolledList chunk is one)
+  with a scalar fallback and AVX2 / AVX-512 kernels picked at run time from
+  what the CPU reports; AArch64 builds always have NEON. Each kernel works
+  on [first, last):
+    find          first element equal to v, or last
+    count         elements equal to v
+    sum           sum, widened to 64 bits
+    sum_positive  sum of the elements > 0 (the fixed sumPositive)
+    min / max     of a non-empty run
+ */
+namespace dll_simd {
+
+enum class Isa { scalar, avx2, avx512, neon };
+
+struct Kernels {
+    Isa isa;
+    const std::int32_t* (*find)(const std::int32_t*, const std::int32_t*, std::int32_t);
+    std::size_t  (*count)(const std::int32_t*, const std::int32_t*, std::int32_t);
+    std::int64_t (*sum)(const std::int32_t*, const std::int32_t*);
+    std::int64_t (*sum_positive)(const std::int32_t*, const std::int32_t*);
+    std::int32_t (*min)(const std::int32_t*, const std::int32_t*);
+    std::int32_t (*max)(const std::int32_t*, const std::int32_t*);
+};
+
+namespace scalar {
+inline const std::int32_t* find(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    while (p != e && *p != v) ++p;
+    return p;
+}
+inline std::size_t count(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    std::size_t n = 0;
+    for (; p != e; ++p) n += *p == v;
+    return n;
+}
+inline std::int64_t sum(const std::int32_t* p, const std::int32_t* e) {
+    std::int64_t s = 0;
+    for (; p != e; ++p) s += *p;
+    return s;
+}
+inline std::int64_t sum_positive(const std::int32_t* p, const std::int32_t* e) {
+    std::int64_t s = 0;
+    for (; p != e; ++p) s += *p > 0 ? *p : 0;
+    return s;
+}
+inline std::int32_t min(const std::int32_t* p, const std::int32_t* e) {
+    std::int32_t m = *p;
+    for (++p; p != e; ++p) m = *p < m ? *p : m;
+    return m;
+}
+inline std::int32_t max(const std::int32_t* p, const std::int32_t* e) {
+    std::int32_t m = *p;
+    for (++p; p != e; ++p) m = *p > m ? *p : m;
+    return m;
+}
+} // namespace scalar
+
+#if DLL_SIMD_X86
+#define DLL_AVX2   __attribute__((target("avx2")))
+#define DLL_AVX512 __attribute__((target("avx512f")))
+
+namespace avx2 {
+DLL_AVX2 inline const std::int32_t* find(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    __m256i key = _mm256_set1_epi32(v);
+    for (; e - p >= 8; p += 8) {
+        __m256i x    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        int     mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, key)));
+        if (mask) return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    return scalar::find(p, e, v);
+}
+DLL_AVX2 inline std::size_t count(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    __m256i     key = _mm256_set1_epi32(v);
+    std::size_t n   = 0;
+    for (; e - p >= 8; p += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        n += static_cast<std::size_t>(
+            __builtin_popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, key))))));
+    }
+    return n + scalar::count(p, e, v);
+}
+// Eight int32 lanes widened into two accumulators of four int64 lanes.
+DLL_AVX2 inline std::int64_t widen_add(const std::int32_t*& p, const std::int32_t* e, bool positive_only) {
+    __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+    __m256i zero = _mm256_setzero_si256();
+    for (; e - p >= 8; p += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        if (positive_only) x = _mm256_max_epi32(x, zero);
+        lo = _mm256_add_epi64(lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        hi = _mm256_add_epi64(hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    alignas(32) std::int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(lo, hi));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+DLL_AVX2 inline std::int64_t sum(const std::int32_t* p, const std::int32_t* e) {
+    std::int64_t s = widen_add(p, e, false);
+    return s + scalar::sum(p, e);
+}
+DLL_AVX2 inline std::int64_t sum_positive(const std::int32_t* p, const std::int32_t* e) {
+    std::int64_t s = widen_add(p, e, true);
+    return s + scalar::sum_positive(p, e);
+}
+DLL_AVX2 inline std::int32_t min(const std::int32_t* p, const std::int32_t* e) {
+    if (e - p < 8) return scalar::min(p, e);
+    __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    for (p += 8; e - p >= 8; p += 8) m = _mm256_min_epi32(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    alignas(32) std::int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), m);
+    std::int32_t r = scalar::min(lanes, lanes + 8);
+    return p == e ? r : std::min(r, scalar::min(p, e));
+}
+DLL_AVX2 inline std::int32_t max(const std::int32_t* p, const std::int32_t* e) {
+    if (e - p < 8) return scalar::max(p, e);
+    __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    for (p += 8; e - p >= 8; p += 8) m = _mm256_max_epi32(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    alignas(32) std::int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), m);
+    std::int32_t r = scalar::max(lanes, lanes + 8);
+    return p == e ? r : std::max(r, scalar::max(p, e));
+}
+} // namespace avx2
+
+// GCC 12's AVX-512 intrinsics seed results with _mm512_undefined_*(), which
+// trips -Wmaybe-uninitialized once inlined; the values are always written.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace avx512 {
+DLL_AVX512 inline const std::int32_t* find(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    __m512i key = _mm512_set1_epi32(v);
+    for (; e - p >= 16; p += 16) {
+        __mmask16 mask = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(p), key);
+        if (mask) return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    return scalar::find(p, e, v);
+}
+DLL_AVX512 inline std::size_t count(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    __m512i     key = _mm512_set1_epi32(v);
+    std::size_t n   = 0;
+    for (; e - p >= 16; p += 16)
+        n += static_cast<std::size_t>(
+            __builtin_popcount(static_cast<unsigned>(_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(p), key))));
+    return n + scalar::count(p, e, v);
+}
+DLL_AVX512 inline std::int64_t widen_add(const std::int32_t*& p, const std::int32_t* e, bool positive_only) {
+    __m512i lo = _mm512_setzero_si512(), hi = _mm512_setzero_si512();
+    __m512i zero = _mm512_setzero_si512();
+    for (; e - p >= 16; p += 16) {
+        __m512i x = _mm512_loadu_si512(p);
+        if (positive_only) x = _mm512_max_epi32(x, zero);
+        lo = _mm512_add_epi64(lo, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(x)));
+        hi = _mm512_add_epi64(hi, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(x, 1)));
+    }
+    return _mm512_reduce_add_epi64(_mm512_add_epi64(lo, hi));
+}
+DLL_AVX512 inline std::int64_t sum(const std::int32_t* p, const std::int32_t* e) {
+    std::int64_t s = widen_add(p, e, false);
+    return s + scalar::sum(p, e);
+}
+DLL_AVX512 inline std::int64_t sum_positive(const std::int32_t* p, const std::int32_t* e) {
+    std::int64_t s = widen_add(p, e, true);
+    return s + scalar::sum_positive(p, e);
+}
+DLL_AVX512 inline std::int32_t min(const std::int32_t* p, const std::int32_t* e) {
+    if (e - p < 16) return scalar::min(p, e);
+    __m512i m = _mm512_loadu_si512(p);
+    for (p += 16; e - p >= 16; p += 16) m = _mm512_min_epi32(m, _mm512_loadu_si512(p));
+    std::int32_t r = _mm512_reduce_min_epi32(m);
+    return p == e ? r : std::min(r, scalar::min(p, e));
+}
+DLL_AVX512 inline std::int32_t max(const std::int32_t* p, const std::int32_t* e) {
+    if (e - p < 16) return scalar::max(p, e);
+    __m512i m = _mm512_loadu_si512(p);
+    for (p += 16; e - p >= 16; p += 16) m = _mm512_max_epi32(m, _mm512_loadu_si512(p));
+    std::int32_t r = _mm512_reduce_max_epi32(m);
+    return p == e ? r : std::max(r, scalar::max(p, e));
+}
+} // namespace avx512
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#undef DLL_AVX2
+#undef DLL_AVX512
+#endif // DLL_SIMD_X86
+
+#if DLL_SIMD_NEON
+namespace neon {
+inline const std::int32_t* find(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    int32x4_t key = vdupq_n_s32(v);
+    for (; e - p >= 4; p += 4)
+        if (vmaxvq_u32(vceqq_s32(vld1q_s32(p), key))) return scalar::find(p, p + 4, v);
+    return scalar::find(p, e, v);
+}
+inline std::size_t count(const std::int32_t* p, const std::int32_t* e, std::int32_t v) {
+    int32x4_t   key = vdupq_n_s32(v);
+    std::size_t n   = 0;
+    for (; e - p >= 4; p += 4) n += vaddvq_u32(vshrq_n_u32(vceqq_s32(vld1q_s32(p), key), 31));
+    return n + scalar::count(p, e, v);
+}
+inline std::int64_t sum(const std::int32_t* p, const std::int32_t* e) {
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; e - p >= 4; p += 4) acc = vpadalq_s32(acc, vld1q_s32(p));
+    return vaddvq_s64(acc) + scalar::sum(p, e);
+}
+inline std::int64_t sum_positive(const std::int32_t* p, const std::int32_t* e) {
+    int64x2_t acc  = vdupq_n_s64(0);
+    int32x4_t zero = vdupq_n_s32(0);
+    for (; e - p >= 4; p += 4) acc = vpadalq_s32(acc, vmaxq_s32(vld1q_s32(p), zero));
+    return vaddvq_s64(acc) + scalar::sum_positive(p, e);
+}
+inline std::int32_t min(const std::int32_t* p, const std::int32_t* e) {
+    if (e - p < 4) return scalar::min(p, e);
+    int32x4_t m = vld1q_s32(p);
+    for (p += 4; e - p >= 4; p += 4) m = vminq_s32(m, vld1q_s32(p));
+    std::int32_t r = vminvq_s32(m);
+    return p == e ? r : std::min(r, scalar::min(p, e));
+}
+inline std::int32_t max(const std::int32_t* p, const std::int32_t* e) {
+    if (e - p < 4) return scalar::max(p, e);
+    int32x4_t m = vld1q_s32(p);
+    for (p += 4; e - p >= 4; p += 4) m = vmaxq_s32(m, vld1q_s32(p));
+    std::int32_t r = vmaxvq_s32(m);
+    return p == e ? r : std::max(r, scalar::max(p, e));
+}
+} // namespace neon
+#endif // DLL_SIMD_NEON
+
+inline const Kernels& table(Isa isa) {
+    static const Kernels scalar_k {Isa::scalar, scalar::find, scalar::count, scalar::sum,
+                                   scalar::sum_positive, scalar::min, scalar::max};
+#if DLL_SIMD_X86
+    static const Kernels avx2_k   {Isa::avx2, avx2::find, avx2::count, avx2::sum,
+                                   avx2::sum_positive, avx2::min, avx2::max};
+    static const Kernels avx512_k {Isa::avx512, avx512::find, avx512::count, avx512::sum,
+                                   avx512::sum_positive, avx512::min, avx512::max};
+    if (isa == Isa::avx512) return avx512_k;
+    if (isa == Isa::avx2)   return avx2_k;
+#endif
+#if DLL_SIMD_NEON
+    static const Kernels neon_k   {Isa::neon, neon::find, neon::count, neon::sum,
+                                   neon::sum_positive, neon::min, neon::max};
+    if (isa == Isa::neon) return neon_k;
+#endif
+    return scalar_k;
+}
+
+// supported – can this CPU run the kernels for isa?
+inline bool supported(Isa isa) {
+    switch (isa) {
+    case Isa::scalar: return true;
+#if DLL_SIMD_X86
+    case Isa::avx2:   return __builtin_cpu_supports("avx2");
+    case Isa::avx512: return __builtin_cpu_supports("avx512f");
+#endif
+#if DLL_SIMD_NEON
+    case Isa::neon:   return true;
+#endif
+    default:          return false;
+    }
+}
+
+inline Isa best() {
+    for (Isa isa : {Isa::avx512, Isa::avx2, Isa::neon})
+        if (supported(isa)) return isa;
+    return Isa::scalar;
+}
+
+inline std::atomic<const Kernels*>& active_slot() {
+    static std::atomic<const Kernels*> slot(&table(best()));
+    return slot;
+}
+
+// The kernels in use: the best the CPU supports unless select() said otherwise.
+inline const Kernels& active() { return *active_slot().load(std::memory_order_relaxed); }
+
+// select – pin the kernels to isa (e.g. scalar, to compare); false if the
+// CPU cannot run it, in which case nothing changes.
+inline bool select(Isa isa) {
+    if (!supported(isa)) return false;
+    active_slot().store(&table(isa), std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace dll_simd
+
+/*
+ dll_sort – the allocation-free merge sort shared by the pointer- and
+  index-linked lists. A chain is a run of links H ending in nil; next(h)
+  returns a reference to h's forward link, less(a, b) compares the elements
+  behind two links. Only forward links are touched: the caller rebuilds
+  prev and tail in one pass afterwards.
+ */
+namespace dll_sort {
+
+/*
+ merge_into – stable merge of the chains into (earlier elements) and from
+  (later ones) into `into`; from ends nil. If less throws, the unmerged
+  remainders are appended before rethrowing so `into` still holds every
+  link.
+ */
+template <typename H, typename Next, typename Less>
+void merge_into(H& into, H& from, H nil, Next& next, Less& less) {
+    H  a = into, b = from, first = nil;
+    H* link = &first;
+    from = nil;
+    try {
+        while (a != nil && b != nil) {
+            H& src = less(b, a) ? b : a;
+            *link = src;
+            link  = &next(src);
+            src   = *link;
+        }
+    } catch (...) {
+        *link = a;
+        while (*link != nil) link = &next(*link);
+        *link = b;
+        into  = first;
+        throw;
+    }
+    *link = a != nil ? a : b;
+    into  = first;
+}
+
+/*
+ sort_chain – bottom-up merge sort: bins[i] holds a sorted run of 2^i links
+  and each new link carries up like a binary counter, so 64 bins cover any
+  length and no memory is allocated. Bins above i hold earlier elements
+  than bin i, which keeps every merge (and so the sort) stable.
+  O(n log n) compares. On return, or if less throws, `first` is a chain of
+  every link (in unspecified order after a throw).
+ */
+template <typename H, typename Next, typename Less>
+void sort_chain(H& first, H nil, Next next, Less less) {
+    H bins[64];
+    for (H& b : bins) b = nil;
+    std::size_t top   = 0;      // bins [0, top) may be occupied
+    H           carry = nil;
+    H           rest  = first;
+    H           done  = nil;
+    try {
+        while (rest != nil) {
+            carry = rest;
+            rest  = next(carry);
+            next(carry) = nil;
+            std::size_t i = 0;
+            for (; i < top && bins[i] != nil; ++i) {
+                merge_into(bins[i], carry, nil, next, less);
+                carry   = bins[i];
+                bins[i] = nil;
+            }
+            bins[i] = carry;
+            carry   = nil;
+            if (i == top) ++top;
+        }
+        for (std::size_t i = 0; i < top; ++i) {
+            if (bins[i] == nil) continue;
+            merge_into(bins[i], done, nil, next, less);
+            done    = bins[i];
+            bins[i] = nil;
+        }
+    } catch (...) {
+        // Stitch every partial run back onto the unsorted remainder.
+        auto prepend = [&](H chain) {
+            if (chain == nil) return;
+            H last = chain;
+            while (next(last) != nil) last = next(last);
+            next(last) = rest;
+            rest = chain;
+        };
+        prepend(carry);
+        prepend(done);
+        for (std::size_t i = 0; i < top; ++i) prepend(bins[i]);
+        first = rest;
+        throw;
+    }
+    first = done;
+}
+
+} // namespace dll_sort
+
+/*
+ dll_numa – just enough NUMA topology for NumaNodePool, straight from
+  sysfs and raw syscalls so there is no libnuma dependency. Elsewhere
+  than Linux there is one node and binding is a no-op.
+ */
+namespace dll_numa {
+
+// Number of memory nodes: one past the highest in .../node/online ("0-1,3").
+inline unsigned node_count() {
+#if defined(__linux__)
+    static const unsigned count = [] {
+        std::ifstream in("/sys/devices/system/node/online");
+        std::string   s;
+        if (!(in >> s)) return 1u;
+        unsigned highest = 0, v = 0;
+        bool     digits  = false;
+        for (char c : s + ",") {
+            if (c >= '0' && c <= '9') {
+                v      = v * 10 + unsigned(c - '0');
+                digits = true;
+            } else {
+                if (digits && v > highest) highest = v;
+                v      = 0;
+                digits = false;
+            }
+        }
+        return highest + 1;
+    }();
+    return count;
+#else
+    return 1;
+#endif
+}
+
+// The node of the CPU the calling thread is running on right now.
+inline unsigned current_node() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return node;
+#endif
+    return 0;
+}
+
+// Ask for [p, p + bytes) to live on node, moving pages already touched.
+// Best effort: false if the kernel said no (or there is no mbind).
+inline bool bind_to_node(void* p, std::size_t bytes, unsigned node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node >= 8 * sizeof(unsigned long)) return false;
+    const int           mpol_preferred = 1, mpol_mf_move = 2;
+    const unsigned long mask           = 1ul << node;
+    return syscall(SYS_mbind, p, bytes, mpol_preferred, &mask, 8 * sizeof(mask), mpol_mf_move) == 0;
+#else
+    (void)p, (void)bytes, (void)node;
+    return false;
+#endif
+}
+
+} // namespace dll_numa
+
+/*
+ dll_thread – hands per-thread state (ConcurrentDeque epoch records,
+  NumaNodePool caches) back to its owner when the thread exits. An owner
+  enrolls for an id and retires it in its destructor; a thread exiting
+  after that skips the owner's hooks. The registry lock is only taken when
+  an owner comes or goes, when a thread claims state and when it exits.
+ */
+namespace dll_thread {
+
+struct Registry {
+    std::mutex                 lock;
+    std::vector<std::uint64_t> live;   // ascending: ids are handed out in order
+    std::uint64_t              last = 0;
+
+    bool alive(std::uint64_t id) const { return std::binary_search(live.begin(), live.end(), id); }
+};
+
+// Never destroyed: a thread may exit after static destruction has begun.
+inline Registry& registry() {
+    static Registry* r = new Registry;
+    return *r;
+}
+
+inline std::uint64_t enroll() {
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    r.live.push_back(++r.last);
+    return r.last;
+}
+
+inline void retire(std::uint64_t id) {
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    auto it = std::lower_bound(r.live.begin(), r.live.end(), id);
+    if (it != r.live.end() && *it == id) r.live.erase(it);
+}
+
+struct ExitHook {
+    std::uint64_t owner;
+    void        (*release)(void* state);
+    void*         state;
+};
+
+// True once the calling thread has started running its exit hooks; state
+// claimed after that would never be given back, so owners must not hand any out.
+inline bool& exiting() {
+    thread_local bool flag = false;
+    return flag;
+}
+
+class ExitHooks {
+public:
+    ~ExitHooks() {
+        exiting() = true;
+        Registry&                   r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (const ExitHook& h : hooks)
+            if (r.alive(h.owner)) h.release(h.state);
+    }
+
+    // Hooks of retired owners are dropped whenever the list would grow.
+    void add(const ExitHook& hook) {
+        if (hooks.size() == hooks.capacity() && !hooks.empty()) {
+            Registry&                   r = registry();
+            std::lock_guard<std::mutex> guard(r.lock);
+            hooks.erase(std::remove_if(hooks.begin(), hooks.end(),
+                                       [&r](const ExitHook& h) { return !r.alive(h.owner); }),
+                        hooks.end());
+        }
+        hooks.push_back(hook);
+    }
+
+private:
+    std::vector<ExitHook> hooks;
+};
+
+// Call release(state) when the calling thread exits, if owner is still alive then.
+inline void at_exit(std::uint64_t owner, void (*release)(void*), void* state) {
+    thread_local ExitHooks hooks;
+    hooks.add({owner, release, state});
+}
+
+} // namespace dll_thread
+
+/*
+ Node – the element lives in an anonymous union so the list controls its
+  lifetime explicitly: the links stay valid after the value is destroyed,
+  which lets the pool thread its free list through `next`.
+ */
+template <typename T>
+struct Node {
+    union { T data; };
+    Node* prev;
+    Node* next;
+
+    Node() : prev(nullptr), next(nullptr) {}
+    ~Node() {}
+};
+
+/*
+ NodePool – slab arena for fixed-size nodes.
+  Nodes are carved out of slabs that double in size (up to max_slab_nodes),
+  and freed nodes go onto an intrusive free list threaded through their own
+  `next` field, so a steady push/pop churn never reaches malloc.
+  Destroying the pool releases whole slabs; nodes are never freed one by one.
+ */
+template <typename NodeT>
+class NodePool {
+public:
+    explicit NodePool(std::size_t first_slab_nodes = 16,
+                      std::size_t max_slab_nodes   = 4096)
+        : slabs(nullptr), free_list(nullptr), free_tail(nullptr),
+          bump(nullptr), bump_end(nullptr),
+          next_slab_nodes(first_slab_nodes ? first_slab_nodes : 1),
+          max_slab_nodes(max_slab_nodes < next_slab_nodes ? next_slab_nodes
+                                                          : max_slab_nodes) {}
+    ~NodePool() { release(); }
+
+    NodePool(const NodePool&)            = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // Raw storage for one node; the caller placement-news into it.
+    void* allocate();
+    // Storage for n nodes side by side in one slab (bulk builds).
+    NodeT* allocate_run(std::size_t n);
+    // Hand one node back to the free list.
+    void  deallocate(NodeT* n);
+    // Hand back a whole chain first..last (linked through `next`) in O(1).
+    void  deallocate_chain(NodeT* first, NodeT* last);
+    // Drop every slab at once. All nodes handed out become invalid.
+    void  release();
+    // Take over every slab and free node of `other`, leaving it empty.
+    // Nodes other handed out stay valid and now belong to this pool.
+    void  absorb(NodePool& other);
+
+private:
+    struct Slab {
+        Slab*       next;
+        std::size_t count;
+    };
+
+    Slab*       slabs;
+    NodeT*      free_list;
+    NodeT*      free_tail;  // kept so absorb() can splice free lists in O(1)
+    NodeT*      bump;       // next never-used node in the newest slab
+    NodeT*      bump_end;
+    std::size_t next_slab_nodes;
+    std::size_t max_slab_nodes;
+
+    static std::size_t header_bytes() {
+        // Round the slab header up so the first node is suitably aligned.
+        return (sizeof(Slab) + alignof(NodeT) - 1) / alignof(NodeT) * alignof(NodeT);
+    }
+    void grow(std::size_t min_nodes = 0);
+};
+
+template <typename NodeT>
+void* NodePool<NodeT>::allocate() {
+    if (free_list) {
+        NodeT* n  = free_list;
+        free_list = free_list->next;
+        if (!free_list) free_tail = nullptr;
+        return n;
+    }
+    if (bump == bump_end) grow();
+    return bump++;
+}
+
+/*
+ allocate_run – carve n adjacent nodes off the bump region. If the current
+  slab cannot fit them, its leftover goes onto the free list and a slab of at
+  least n nodes is started.
+ */
+template <typename NodeT>
+NodeT* NodePool<NodeT>::allocate_run(std::size_t n) {
+    if (!n) return nullptr;
+    if (std::size_t(bump_end - bump) < n) {
+        while (bump != bump_end) deallocate(bump++);
+        grow(n);
+    }
+    NodeT* run = bump;
+    bump += n;
+    return run;
+}
+
+template <typename NodeT>
+void NodePool<NodeT>::deallocate(NodeT* n) {
+    if (!free_list) free_tail = n;
+    n->next   = free_list;
+    free_list = n;
+}
+
+template <typename NodeT>
+void NodePool<NodeT>::deallocate_chain(NodeT* first, NodeT* last) {
+    if (!first) return;
+    if (!free_list) free_tail = last;
+    last->next = free_list; // the chain is already linked, just cap it
+    free_list  = first;
+}
+
+template <typename NodeT>
+void NodePool<NodeT>::release() {
+    while (slabs) {
+        Slab* next = slabs->next;
+        ::operator delete(static_cast<void*>(slabs));
+        slabs = next;
+    }
+    free_list = free_tail = bump = bump_end = nullptr;
+}
+
+/*
+ absorb – the leftover of other's bump region is threaded onto its free list,
+  then both the free list and the slab chain are prepended to ours.
+  O(slabs + one slab's leftover); slabs grow geometrically so that is small.
+ */
+template <typename NodeT>
+void NodePool<NodeT>::absorb(NodePool& other) {
+    if (&other == this || !other.slabs) return;
+    while (other.bump != other.bump_end) other.deallocate(other.bump++);
+    if (other.free_list) {
+        other.free_tail->next = free_list;
+        if (!free_list) free_tail = other.free_tail;
+        free_list = other.free_list;
+    }
+    Slab* last = other.slabs;
+    while (last->next) last = last->next;
+    last->next = slabs;
+    slabs      = other.slabs;
+    if (next_slab_nodes < other.next_slab_nodes) next_slab_nodes = other.next_slab_nodes;
+    other.slabs     = nullptr;
+    other.free_list = other.free_tail = other.bump = other.bump_end = nullptr;
+}
+
+template <typename NodeT>
+void NodePool<NodeT>::grow(std::size_t min_nodes) {
+    std::size_t count = next_slab_nodes < min_nodes ? min_nodes : next_slab_nodes;
+    void*       raw   = ::operator new(header_bytes() + count * sizeof(NodeT));
+    Slab*       s     = static_cast<Slab*>(raw);
+    s->next  = slabs;
+    s->count = count;
+    slabs    = s;
+    bump     = reinterpret_cast<NodeT*>(static_cast<char*>(raw) + header_bytes());
+    bump_end = bump + count;
+    if (next_slab_nodes < max_slab_nodes)
+        next_slab_nodes = next_slab_nodes * 2 < max_slab_nodes ? next_slab_nodes * 2
+                                                               : max_slab_nodes;
+}
+
+/*
+ Allocator policies for DoublyLinkedList. Each one provides
+      void* allocate();
+      void* allocate_run(std::size_t n);    // n adjacent nodes, or nullptr
+      void  deallocate(NodeT*);
+      void  deallocate_chain(NodeT* first, NodeT* last);
+      bool  operator==(const Alloc&) const; // can free each other's nodes
+      bool  absorb(Alloc& other);           // make other's nodes freeable here
+ absorb() returning false means nodes cannot move between the two lists,
+ and node-transferring operations fall back to moving elements.
+*/
+
+// PoolAllocator – every list gets a private NodePool (the default).
+// Copies share the pool, so lists split off one another stay compatible;
+// a NodePool is not thread-safe, so such lists must stay on one thread.
+template <typename NodeT>
+class PoolAllocator {
+public:
+    void* allocate()                  { return get().allocate(); }
+    void* allocate_run(std::size_t n) { return get().allocate_run(n); }
+    void  deallocate(NodeT* n)        { pool->deallocate(n); }
+    void  deallocate_chain(NodeT* first, NodeT* last) {
+        if (first) pool->deallocate_chain(first, last);
+    }
+
+    bool operator==(const PoolAllocator& o) const { return pool == o.pool; }
+    bool absorb(PoolAllocator& other);
+
+private:
+    std::shared_ptr<NodePool<NodeT>> pool; // created on first allocation
+
+    NodePool<NodeT>& get() {
+        if (!pool) pool = std::make_shared<NodePool<NodeT>>();
+        return *pool;
+    }
+};
+
+/*
+ absorb – take over other's slabs, which is only safe when no third list
+  still draws from them. With no pool of our own we take other's whole pool
+  and other starts a fresh one on its next allocation, so the two lists never
+  end up sharing one.
+ */
+template <typename NodeT>
+bool PoolAllocator<NodeT>::absorb(PoolAllocator& other) {
+    if (pool == other.pool || !other.pool) return true;
+    if (other.pool.use_count() != 1) return false;
+    if (!pool) {
+        pool = std::move(other.pool);
+        return true;
+    }
+    pool->absorb(*other.pool);
+    return true;
+}
+
+// SharedPoolAllocator – many lists draw from one arena owned by the caller.
+template <typename NodeT>
+class SharedPoolAllocator {
+public:
+    explicit SharedPoolAllocator(NodePool<NodeT>& arena) : pool(&arena) {}
+
+    void* allocate()                                 { return pool->allocate(); }
+    void* allocate_run(std::size_t n)                { return pool->allocate_run(n); }
+    void  deallocate(NodeT* n)                       { pool->deallocate(n); }
+    void  deallocate_chain(NodeT* first, NodeT* last) { pool->deallocate_chain(first, last); }
+
+    bool operator==(const SharedPoolAllocator& o) const { return pool == o.pool; }
+    bool absorb(SharedPoolAllocator& other) { return *this == other; }
+
+private:
+    NodePool<NodeT>* pool;
+};
+
+// HeapAllocator – one operator new/delete per node.
+template <typename NodeT>
+class HeapAllocator {
+public:
+    void* allocate()                { return ::operator new(sizeof(NodeT)); }
+    void* allocate_run(std::size_t) { return nullptr; } // nodes are freed one by one
+    void  deallocate(NodeT* n)      { ::operator delete(static_cast<void*>(n)); }
+    void  deallocate_chain(NodeT* first, NodeT* last) {
+        while (first) {
+            NodeT* next = first == last ? nullptr : first->next;
+            deallocate(first);
+            first = next;
+        }
+    }
+
+    bool operator==(const HeapAllocator&) const { return true; }
+    bool absorb(HeapAllocator&) { return true; }
+};
+
+/*
+ NumaNodePool – a node arena any number of threads can share, for lists
+  whose nodes are pushed on one thread and popped on another.
+
+  Memory comes in 64 KiB slabs, each bound to one NUMA node (its home) and
+  aligned to its size, so a node finds its home from its own address. Each
+  thread keeps a small free list per home. A freed node goes onto the list
+  of its own home, wherever the freeing thread runs, and once a list holds
+  two batches one batch goes back to that home's shared free list under
+  its lock. An allocation pops the list of the home it asks for, refilling
+  a batch from that home when empty, so the locks are taken once per batch
+  rather than per node and remote memory never stays in a foreign home.
+
+  A thread's bins go back to their homes when it exits, freeing its cache
+  for another thread. Threads beyond max_threads at once get no cache and
+  take and return nodes on the shared lists directly, one lock per node.
+  All memory is released with the pool. Machines with more than max_homes
+  nodes fold the extra nodes onto the first ones.
+ */
+template <typename NodeT>
+class NumaNodePool {
+public:
+    static constexpr std::size_t   slab_bytes  = 64 * 1024;
+    static constexpr unsigned      max_homes   = 8;
+    static constexpr std::size_t   max_threads = 128;   // distinct threads per pool
+    static constexpr std::uint32_t batch       = 64;    // nodes per refill or return
+
+    static_assert(sizeof(NodeT) * 16 <= slab_bytes, "node too large for a pool slab");
+
+    NumaNodePool();
+    ~NumaNodePool();
+
+    NumaNodePool(const NumaNodePool&)            = delete;
+    NumaNodePool& operator=(const NumaNodePool&) = delete;
+
+    // Storage for one node on home (or on the caller's node if home < 0).
+    void*    allocate(int home = -1);
+    void     deallocate(NodeT* n);
+    unsigned homes() const { return home_count; }
+    // The home the calling thread's allocations go to by default.
+    unsigned local_home();
+    unsigned home_of(const NodeT* n) const { return slab_of(n)->home; }
+
+private:
+    struct Slab {
+        unsigned home;
+        Slab*    next;
+    };
+    struct alignas(64) Home {
+        std::mutex lock;
+        NodeT*     free     = nullptr;
+        Slab*      slabs    = nullptr;
+        NodeT*     bump     = nullptr;   // never-used nodes of the newest slab
+        NodeT*     bump_end = nullptr;
+    };
+    struct Bin {
+        NodeT*        head  = nullptr;
+        std::uint32_t count = 0;
+    };
+    struct alignas(64) ThreadCache {
+        std::atomic<std::uintptr_t> owner{0};
+        NumaNodePool*               pool          = nullptr;
+        unsigned                    node          = 0;
+        std::uint32_t               until_refresh = 0;   // allocations before re-reading node
+        Bin                         bins[max_homes];
+    };
+
+    static constexpr std::size_t header_bytes =
+        (sizeof(Slab) + alignof(NodeT) - 1) / alignof(NodeT) * alignof(NodeT);
+
+    Home                     home_[max_homes];
+    unsigned                 home_count;
+    ThreadCache              caches[max_threads];
+    std::atomic<std::size_t> caches_used{0};
+    std::uint64_t            id;
+
+    static Slab* slab_of(const NodeT* n) {
+        return reinterpret_cast<Slab*>(reinterpret_cast<std::uintptr_t>(n) & ~(slab_bytes - 1));
+    }
+    // The calling thread's last cache lookup, on any pool of this NodeT.
+    struct Last {
+        std::uint64_t id    = 0;
+        ThreadCache*  cache = nullptr;
+    };
+    static Last& last_lookup() {
+        thread_local Last last;
+        return last;
+    }
+
+    ThreadCache* cache();
+    ThreadCache* claim_cache(std::uintptr_t me);
+    static void  release_cache(void* c);
+    void         refill(Bin& bin, unsigned h);
+    void         give_back(Bin& bin, unsigned h);
+    NodeT*       carve(Home& home, unsigned h);
+};
+
+template <typename NodeT>
+NumaNodePool<NodeT>::NumaNodePool()
+    : home_count(std::min(dll_numa::node_count(), max_homes)), id(dll_thread::enroll()) {}
+
+template <typename NodeT>
+NumaNodePool<NodeT>::~NumaNodePool() {
+    dll_thread::retire(id);
+    for (Home& h : home_)
+        while (Slab* s = h.slabs) {
+            h.slabs = s->next;
+            ::operator delete(static_cast<void*>(s), std::align_val_t(slab_bytes));
+        }
+}
+
+/*
+ cache – find (or claim) the calling thread's cache, as ConcurrentDeque
+  finds its epoch records; null when every cache is taken. The node a thread
+  runs on is re-read every 4096 allocations, in case the scheduler has
+  moved it.
+ */
+template <typename NodeT>
+typename NumaNodePool<NodeT>::ThreadCache* NumaNodePool<NodeT>::cache() {
+    thread_local char tag;
+    Last&             last = last_lookup();
+    if (last.id != id) {
+        std::uintptr_t me = reinterpret_cast<std::uintptr_t>(&tag);
+        std::size_t    n  = std::min(caches_used.load(std::memory_order_acquire), max_threads);
+        ThreadCache*   c  = nullptr;
+        for (std::size_t i = 0; i < n && !c; ++i)
+            if (caches[i].owner.load(std::memory_order_relaxed) == me) c = &caches[i];
+        if (!c && !(c = claim_cache(me))) return nullptr;
+        last.id    = id;
+        last.cache = c;
+    }
+    ThreadCache& c = *last.cache;
+    if (c.until_refresh-- == 0) {
+        c.node          = dll_numa::current_node() % home_count;
+        c.until_refresh = 4096;
+    }
+    return &c;
+}
+
+/*
+ claim_cache – a cache given back by an exited thread, else a never-used one.
+  Every claim is a CAS from a zero owner: a fresh slot is visible to other
+  threads' scans as soon as caches_used covers it, so whoever wins the CAS
+  keeps it and the loser looks again.
+ */
+template <typename NodeT>
+typename NumaNodePool<NodeT>::ThreadCache* NumaNodePool<NodeT>::claim_cache(std::uintptr_t me) {
+    if (dll_thread::exiting()) return nullptr;
+    auto try_claim = [me](ThreadCache& c) {
+        std::uintptr_t expected = 0;
+        return c.owner.load(std::memory_order_relaxed) == 0 &&
+               c.owner.compare_exchange_strong(expected, me, std::memory_order_acquire);
+    };
+    ThreadCache* c = nullptr;
+    while (!c) {
+        std::size_t n = std::min(caches_used.load(std::memory_order_acquire), max_threads);
+        for (std::size_t i = 0; i < n && !c; ++i)
+            if (try_claim(caches[i])) c = &caches[i];
+        if (c) break;
+        if (n == max_threads) return nullptr;
+        std::size_t i = caches_used.fetch_add(1, std::memory_order_acq_rel);
+        if (i >= max_threads) return nullptr;
+        if (try_claim(caches[i])) c = &caches[i];
+    }
+    c->pool = this;
+    dll_thread::at_exit(id, &release_cache, c);
+    return c;
+}
+
+// release_cache – at thread exit, splice every bin back onto its home's free list.
+template <typename NodeT>
+void NumaNodePool<NodeT>::release_cache(void* p) {
+    ThreadCache& c = *static_cast<ThreadCache*>(p);
+    for (unsigned h = 0; h < max_homes; ++h) {
+        Bin& bin = c.bins[h];
+        if (!bin.head) continue;
+        NodeT* last = bin.head;
+        while (last->next) last = last->next;
+        Home&                       home = c.pool->home_[h];
+        std::lock_guard<std::mutex> guard(home.lock);
+        last->next = home.free;
+        home.free  = bin.head;
+        bin        = Bin();
+    }
+    c.until_refresh = 0;
+    // Runs on the exiting thread: later thread_local destructors there that
+    // allocate must not reach this cache again once another thread claims it.
+    Last& last = last_lookup();
+    if (last.cache == &c) last = Last();
+    c.owner.store(0, std::memory_order_release);
+}
+
+template <typename NodeT>
+unsigned NumaNodePool<NodeT>::local_home() {
+    ThreadCache* c = cache();
+    return c ? c->node : dll_numa::current_node() % home_count;
+}
+
+template <typename NodeT>
+void* NumaNodePool<NodeT>::allocate(int home) {
+    ThreadCache* c = cache();
+    if (!c) {
+        unsigned                    h = (home < 0 ? dll_numa::current_node() : unsigned(home)) % home_count;
+        std::lock_guard<std::mutex> guard(home_[h].lock);
+        if (NodeT* n = home_[h].free) {
+            home_[h].free = n->next;
+            return n;
+        }
+        return carve(home_[h], h);
+    }
+    unsigned h   = home < 0 ? c->node : unsigned(home) % home_count;
+    Bin&     bin = c->bins[h];
+    if (!bin.head) refill(bin, h);
+    NodeT* n = bin.head;
+    bin.head = n->next;
+    --bin.count;
+    return n;
+}
+
+template <typename NodeT>
+void NumaNodePool<NodeT>::deallocate(NodeT* n) {
+    unsigned     h = home_of(n);
+    ThreadCache* c = cache();
+    if (!c) {
+        std::lock_guard<std::mutex> guard(home_[h].lock);
+        n->next       = home_[h].free;
+        home_[h].free = n;
+        return;
+    }
+    Bin& bin = c->bins[h];
+    n->next  = bin.head;
+    bin.head = n;
+    if (++bin.count >= 2 * batch) give_back(bin, h);
+}
+
+/*
+ refill – move a batch into an empty bin: from the home's free list while it
+  lasts, then off its bump region, starting a fresh slab bound to the home's
+  node when that runs out too.
+ */
+template <typename NodeT>
+void NumaNodePool<NodeT>::refill(Bin& bin, unsigned h) {
+    Home&                       home = home_[h];
+    std::lock_guard<std::mutex> guard(home.lock);
+    while (bin.count < batch && home.free) {
+        NodeT* n  = home.free;
+        home.free = n->next;
+        n->next   = bin.head;
+        bin.head  = n;
+        ++bin.count;
+    }
+    while (bin.count < batch) {
+        NodeT* n = carve(home, h);
+        n->next  = bin.head;
+        bin.head = n;
+        ++bin.count;
+    }
+}
+
+// carve – one never-used node off home's bump region; the caller holds its lock.
+template <typename NodeT>
+NodeT* NumaNodePool<NodeT>::carve(Home& home, unsigned h) {
+    if (home.bump == home.bump_end) {
+        void* raw = ::operator new(slab_bytes, std::align_val_t(slab_bytes));
+        dll_numa::bind_to_node(raw, slab_bytes, h);
+        Slab* s       = static_cast<Slab*>(raw);
+        s->home       = h;
+        s->next       = home.slabs;
+        home.slabs    = s;
+        home.bump     = reinterpret_cast<NodeT*>(static_cast<char*>(raw) + header_bytes);
+        home.bump_end = home.bump + (slab_bytes - header_bytes) / sizeof(NodeT);
+    }
+    return home.bump++;
+}
+
+// give_back – return the newest batch of a full bin to its home in one splice.
+template <typename NodeT>
+void NumaNodePool<NodeT>::give_back(Bin& bin, unsigned h) {
+    NodeT* first = bin.head;
+    NodeT* last  = first;
+    for (std::uint32_t i = 1; i < batch; ++i) last = last->next;
+    bin.head = last->next;
+    bin.count -= batch;
+    Home&                       home = home_[h];
+    std::lock_guard<std::mutex> guard(home.lock);
+    last->next = home.free;
+    home.free  = first;
+}
+
+// Placement for NumaPoolAllocator: numa_local follows the allocating thread.
+constexpr int numa_local = -1;
+
+/*
+ NumaPoolAllocator – lists drawing from one shared NumaNodePool. Nodes go
+  on the node given at construction, e.g. the one the consuming thread runs
+  on (dll_numa::current_node() there), or with numa_local on whichever node
+  the allocating thread is running. Any list on the same pool can free
+  them from any thread.
+ */
+template <typename NodeT>
+class NumaPoolAllocator {
+public:
+    explicit NumaPoolAllocator(NumaNodePool<NodeT>& arena, int node = numa_local)
+        : pool(&arena), placement(node) {}
+
+    void* allocate()                  { return pool->allocate(placement); }
+    void* allocate_run(std::size_t)   { return nullptr; }   // nodes may each go home separately
+    void  deallocate(NodeT* n)        { pool->deallocate(n); }
+    void  deallocate_chain(NodeT* first, NodeT* last) {
+        while (first) {
+            NodeT* next = first == last ? nullptr : first->next;
+            pool->deallocate(first);
+            first = next;
+        }
+    }
+
+    bool operator==(const NumaPoolAllocator& o) const { return pool == o.pool; }
+    bool absorb(NumaPoolAllocator& other) { return *this == other; }
+
+    int placement_node() const { return placement; }
+
+private:
+    NumaNodePool<NodeT>* pool;
+    int                  placement;
+};
+
+/*
+ InlineAllocator – the first N nodes come from a buffer inside the
+  allocator, and so inside the list object itself; past that the list
+  spills to Fallback. A short list never allocates at all.
+  Inline nodes cannot change owner, so absorb() only succeeds while the
+  other side holds no inline nodes, and moving a list rebuilds its inline
+  nodes in the new buffer (relocate_from) instead of handing them over.
+ */
+template <typename NodeT, std::size_t N, typename Fallback = PoolAllocator<NodeT>>
+class InlineAllocator {
+    static_assert(N > 0 && N <= 64, "InlineAllocator holds 1 to 64 inline nodes");
+
+public:
+    static constexpr std::size_t inline_capacity = N;
+
+    InlineAllocator() : used(0) {}
+    explicit InlineAllocator(const Fallback& f) : used(0), fallback(f) {}
+    // Copies and moves carry the fallback only; the inline buffer starts empty.
+    InlineAllocator(const InlineAllocator& o) : used(0), fallback(o.fallback) {}
+    InlineAllocator(InlineAllocator&& o) noexcept : used(0), fallback(std::move(o.fallback)) {}
+    InlineAllocator& operator=(const InlineAllocator& o) { fallback = o.fallback; return *this; }
+    InlineAllocator& operator=(InlineAllocator&& o) noexcept { fallback = std::move(o.fallback); return *this; }
+
+    void* allocate() {
+        if (~used & full_mask()) {
+            unsigned i = static_cast<unsigned>(__builtin_ctzll(~used));
+            used |= std::uint64_t(1) << i;
+            return slot(i);
+        }
+        return fallback.allocate();
+    }
+    // Bulk runs come from the fallback once the inline slots are gone;
+    // until then nodes are handed out one at a time to fill them first.
+    void* allocate_run(std::size_t n) { return (used == full_mask()) ? fallback.allocate_run(n) : nullptr; }
+    void  deallocate(NodeT* n) {
+        if (owns(n)) used &= ~(std::uint64_t(1) << index_of(n));
+        else         fallback.deallocate(n);
+    }
+    void  deallocate_chain(NodeT* first, NodeT* last);
+
+    bool operator==(const InlineAllocator& o) const { return this == &o; }
+    bool absorb(InlineAllocator& other) { return other.used == 0 && fallback.absorb(other.fallback); }
+
+    bool        owns(const NodeT* n) const {
+        return std::less_equal<const void*>()(buf, n) && std::less<const void*>()(n, buf + sizeof(buf));
+    }
+    std::size_t inline_in_use() const { return static_cast<std::size_t>(__builtin_popcountll(used)); }
+
+    // relocate_from – move from's inline nodes into the same slots here (ours
+    // must be empty) and repoint every link to them, head and tail included.
+    void relocate_from(InlineAllocator& from, NodeT*& head, NodeT*& tail);
+
+private:
+    alignas(NodeT) unsigned char buf[N * sizeof(NodeT)];
+    std::uint64_t                used;      // bit i set: slot i holds a live node
+    Fallback                     fallback;
+
+    static constexpr std::uint64_t full_mask() { return N == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << N) - 1; }
+    NodeT*   slot(std::size_t i)           { return reinterpret_cast<NodeT*>(buf) + i; }
+    unsigned index_of(const NodeT* n) const { return static_cast<unsigned>(n - reinterpret_cast<const NodeT*>(buf)); }
+};
+
+/*
+ deallocate_chain – inline nodes are cut out of the chain and freed here;
+  what remains is still linked through `next` and goes to the fallback in
+  one call. The walk stops as soon as no inline node can be left in it.
+ */
+template <typename NodeT, std::size_t N, typename Fallback>
+void InlineAllocator<NodeT, N, Fallback>::deallocate_chain(NodeT* first, NodeT* last) {
+    if (!first) return;
+    if (!used) {
+        fallback.deallocate_chain(first, last);
+        return;
+    }
+    NodeT*      keep_first = nullptr;
+    NodeT*      keep_last  = nullptr;
+    std::size_t pending    = inline_in_use();
+    for (NodeT* cur = first;;) {
+        NodeT* next = cur == last ? nullptr : cur->next;
+        if (owns(cur)) {
+            used &= ~(std::uint64_t(1) << index_of(cur));
+            --pending;
+        } else {
+            if (keep_last) keep_last->next = cur;
+            else           keep_first = cur;
+            keep_last = cur;
+        }
+        if (!next) break;
+        if (!pending) {   // next..last are all fallback nodes, still linked
+            if (keep_last) keep_last->next = next;
+            else           keep_first = next;
+            keep_last = last;
+            break;
+        }
+        cur = next;
+    }
+    if (keep_first) fallback.deallocate_chain(keep_first, keep_last);
+}
+
+template <typename NodeT, std::size_t N, typename Fallback>
+void InlineAllocator<NodeT, N, Fallback>::relocate_from(InlineAllocator& from, NodeT*& head, NodeT*& tail) {
+    using value_type = typename std::remove_reference<decltype(std::declval<NodeT&>().data)>::type;
+    auto moved = [&](NodeT* p) { return from.owns(p) ? slot(from.index_of(p)) : p; };
+
+    for (std::uint64_t bits = from.used; bits; bits &= bits - 1) {
+        unsigned i   = static_cast<unsigned>(__builtin_ctzll(bits));
+        NodeT*   src = from.slot(i);
+        NodeT*   dst = new (slot(i)) NodeT();
+        ::new (static_cast<void*>(std::addressof(dst->data))) value_type(std::move(src->data));
+        src->data.~value_type();
+        dst->prev = src->prev;
+        dst->next = src->next;
+    }
+    used      = from.used;
+    from.used = 0;
+    for (std::uint64_t bits = used; bits; bits &= bits - 1) {
+        NodeT* n = slot(static_cast<unsigned>(__builtin_ctzll(bits)));
+        n->prev  = moved(n->prev);
+        n->next  = moved(n->next);
+        if (n->prev && !owns(n->prev)) n->prev->next = n;   // fallback neighbours
+        if (n->next && !owns(n->next)) n->next->prev = n;
+    }
+    head = moved(head);
+    tail = moved(tail);
+}
+
+// Allocators with storage inside the list (InlineAllocator) need the list
+// to relocate nodes on a move rather than just take the pointers.
+template <typename A, typename = void>
+struct has_inline_storage : std::false_type {};
+template <typename A>
+struct has_inline_storage<A, decltype(void(A::inline_capacity))> : std::true_type {};
+
+
+template <typename T, typename Allocator = PoolAllocator<Node<T>>>
+class DoublyLinkedList {
+    template <bool Const> class basic_iterator;
+    template <bool Const> class basic_streaming_iterator;
+
+public:
+    using value_type             = T;
+    using node_type              = Node<T>;
+    using reference              = T&;
+    using const_reference        = const T&;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using iterator               = basic_iterator<false>;
+    using const_iterator         = basic_iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using streaming_iterator       = basic_streaming_iterator<false>;
+    using const_streaming_iterator = basic_streaming_iterator<true>;
+
+    DoublyLinkedList() : head(nullptr), tail(nullptr), size_(0) {}
+    explicit DoublyLinkedList(const Allocator& a)
+        : head(nullptr), tail(nullptr), size_(0), alloc(a) {}
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    DoublyLinkedList(InputIt first, InputIt last, const Allocator& a = Allocator())
+        : head(nullptr), tail(nullptr), size_(0), alloc(a) { append_range(first, last); }
+    DoublyLinkedList(std::initializer_list<T> il, const Allocator& a = Allocator())
+        : DoublyLinkedList(il.begin(), il.end(), a) {}
+    ~DoublyLinkedList();
+
+    // Moves steal head/tail/size_ and the allocator; no node is touched,
+    // except that nodes stored inside an InlineAllocator are moved across.
+    DoublyLinkedList(DoublyLinkedList&& other) noexcept(nothrow_relocate)
+        : head(nullptr), tail(nullptr), size_(0), alloc(std::move(other.alloc)) {
+        steal(other);
+    }
+    DoublyLinkedList& operator=(DoublyLinkedList&& other) noexcept(nothrow_relocate);
+
+
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value)      { emplace_front(std::move(value)); }
+    void push_back(const T& value)  { emplace_back(value); }
+    void push_back(T&& value)       { emplace_back(std::move(value)); }
+
+    // Construct the element in place inside a freshly allocated node.
+    template <typename... Args> T& emplace_front(Args&&... args);
+    template <typename... Args> T& emplace_back(Args&&... args);
+
+    // Move the element out of the node, then recycle the node.
+    T    pop_front();
+    T    pop_back();
+
+    // Non-throwing pops for polling loops: an empty list is not an error.
+    std::optional<T> try_pop_front();
+    std::optional<T> try_pop_back();
+    // Move up to n elements into out (in pop order) and unlink them in one
+    // pass; the nodes go back to the allocator as a single chain.
+    template <typename OutputIt> std::size_t pop_front_n(OutputIt out, std::size_t n);
+    template <typename OutputIt> std::size_t pop_back_n(OutputIt out, std::size_t n);
+
+    // Peeks; the list must not be empty.
+    T&       front()       { return head->data; }
+    const T& front() const { return head->data; }
+    T&       back()        { return tail->data; }
+    const T& back()  const { return tail->data; }
+
+    // O(1) insertion before pos and removal at pos.
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value)      { return emplace(pos, std::move(value)); }
+    template <typename... Args> iterator emplace(const_iterator pos, Args&&... args);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+
+    /*
+     Bulk builds: the new nodes are linked into a private chain (from one
+     contiguous pool run when the length is known up front) and joined to
+     the list with a single splice.
+     */
+    template <typename InputIt> iterator insert_range(const_iterator pos, InputIt first, InputIt last);
+    template <typename InputIt> void append_range(InputIt first, InputIt last)  { insert_range(cend(), first, last); }
+    template <typename InputIt> void prepend_range(InputIt first, InputIt last) { insert_range(cbegin(), first, last); }
+    // Reuses existing nodes for the overlap, then appends or trims the rest.
+    template <typename InputIt> void assign(InputIt first, InputIt last);
+
+    void clear() noexcept;
+
+    // Relink every node of `other` before pos (or onto one end of this list);
+    // other ends empty.
+    void splice(const_iterator pos, DoublyLinkedList& other);
+    void splice_front(DoublyLinkedList& other) { splice(cbegin(), other); }
+    void splice_back(DoublyLinkedList& other)  { splice(cend(), other); }
+    // Stable merge of two lists already sorted by comp; relinks only.
+    template <typename Compare> void merge(DoublyLinkedList& other, Compare comp);
+    void merge(DoublyLinkedList& other) { merge(other, std::less<T>()); }
+    // Keep the first k elements, return the rest as a new list. O(min(k, n-k)).
+    DoublyLinkedList split_at(std::size_t k);
+    // Stable in-place merge sort; relinks nodes, never allocates or moves T.
+    template <typename Compare> void sort(Compare comp);
+    void sort() { sort(std::less<T>()); }
+    // Drop each element equal to the one before it; returns how many went.
+    template <typename BinaryPred> std::size_t unique(BinaryPred pred);
+    std::size_t unique() { return unique(std::equal_to<T>()); }
+    // Insert after any equal elements so a sorted list stays sorted. O(n),
+    // O(1) when value belongs at the back.
+    template <typename Compare> iterator insert_sorted(T value, Compare comp);
+    iterator insert_sorted(T value) { return insert_sorted(std::move(value), std::less<T>()); }
+
+    iterator               begin()         { return iterator(head, this); }
+    iterator               end()           { return iterator(nullptr, this); }
+    const_iterator         begin()   const { return const_iterator(head, this); }
+    const_iterator         end()     const { return const_iterator(nullptr, this); }
+    const_iterator         cbegin()  const { return begin(); }
+    const_iterator         cend()    const { return end(); }
+    reverse_iterator       rbegin()        { return reverse_iterator(end()); }
+    reverse_iterator       rend()          { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin()  const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()    const { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const { return rbegin(); }
+    const_reverse_iterator crend()   const { return rend(); }
+
+    /*
+     Prefetching scans (see dll_prefetch) for long walks over lists whose
+     nodes are scattered: for_each calls f on every element in dir order,
+     stream() is for range-for, forward only.
+     */
+    template <typename F> void for_each(F f, dll_io::Direction dir = dll_io::Direction::forward) {
+        scan<T&>(f, dir);
+    }
+    template <typename F> void for_each(F f, dll_io::Direction dir = dll_io::Direction::forward) const {
+        scan<const T&>(f, dir);
+    }
+    dll_prefetch::Range<streaming_iterator> stream() {
+        return {streaming_iterator(head), streaming_iterator()};
+    }
+    dll_prefetch::Range<const_streaming_iterator> stream() const {
+        return {const_streaming_iterator(head), const_streaming_iterator()};
+    }
+    // Move the elements into one run of adjacent nodes in list order, so a
+    // list scattered by churn scans like a freshly built one. Invalidates
+    // iterators and references. False, and nothing moved, when the
+    // allocator cannot hand out runs.
+    bool relayout();
+
+    std::size_t size() const { return size_; }
+    bool        empty() const { return size_ == 0; }
+    // Block-buffered dump; framed adds the "[head] ... [null]" markers.
+    void        write_to(std::ostream& os, dll_io::Direction dir = dll_io::Direction::forward,
+                         bool framed = false) const;
+#if DLL_HAVE_POSIX_WRITE
+    void        write_to(int fd, dll_io::Direction dir = dll_io::Direction::forward,
+                         bool framed = false) const;
+#endif
+    void        print_forward()  const;
+    void        print_backward() const;
+
+    // Binary checkpoint (see dll_snapshot). Loading appends to this list.
+    void        save_snapshot(std::ostream& os) const;
+    void        load_snapshot(std::istream& is);
+    // From a file: mmap it and build every node in one bulk pass.
+    void        load_snapshot(const char* path);
+
+    /*
+     Parallel scans, one thread per part; f, pred, fold and combine run
+     concurrently and must only read shared state. reduce runs
+     fold(U, const T&) over each part starting from identity, then merges
+     the parts in order with combine(U, U), which must be associative and
+     have identity as its neutral value.
+     Finding the cut points is an O(n) walk of its own: partition() lets
+     callers that scan the same list repeatedly pay it once. Its cuts stay
+     valid until the list's structure next changes.
+     */
+    std::vector<const_iterator> partition(std::size_t parts) const;
+    template <typename F> void parallel_for_each(F f, unsigned threads = 0) const {
+        parallel_for_each(partition(dll_parallel::part_count(size_, threads)), f);
+    }
+    template <typename U, typename Fold, typename Combine>
+    U parallel_reduce(U identity, Fold fold, Combine combine, unsigned threads = 0) const {
+        return parallel_reduce(partition(dll_parallel::part_count(size_, threads)), std::move(identity),
+                               fold, combine);
+    }
+    template <typename Pred> std::size_t parallel_count_if(Pred pred, unsigned threads = 0) const {
+        return parallel_count_if(partition(dll_parallel::part_count(size_, threads)), pred);
+    }
+    template <typename F>
+    void        parallel_for_each(const std::vector<const_iterator>& cuts, F f) const;
+    template <typename U, typename Fold, typename Combine>
+    U           parallel_reduce(const std::vector<const_iterator>& cuts, U identity, Fold fold,
+                                Combine combine) const;
+    template <typename Pred>
+    std::size_t parallel_count_if(const std::vector<const_iterator>& cuts, Pred pred) const;
+
+private:
+    static constexpr bool nothrow_relocate =
+        !has_inline_storage<Allocator>::value || std::is_nothrow_move_constructible<T>::value;
+
+    node_type*  head;
+    node_type*  tail;
+    std::size_t size_;
+    Allocator   alloc;
+
+    template <typename... Args> node_type* make_node(Args&&... args);
+    void destroy_node(node_type* n);
+    void steal(DoublyLinkedList& other);
+    T    take_front();
+    T    take_back();
+    template <typename InputIt>
+    std::size_t build_chain(InputIt first, InputIt last, node_type*& chain_head, node_type*& chain_tail);
+    template <typename Sink>
+    void        write_with(Sink& sink, dll_io::Direction dir, bool framed) const;
+    template <typename Ref, typename F>
+    void        scan(F& f, dll_io::Direction dir) const;
+    // Move the nodes from cut (the k-th) to the back onto the empty rest,
+    // whose allocator must already be able to free them.
+    void        cut_before(node_type* cut, std::size_t k, DoublyLinkedList& rest) noexcept;
+
+    // SkipIndexedList keeps node pointers in its express lanes.
+    template <typename, typename> friend class SkipIndexedList;
+    iterator          make_iterator(node_type* n) { return iterator(n, this); }
+    static node_type* node_of(const_iterator it)  { return it.node; }
+
+    DoublyLinkedList(const DoublyLinkedList&)            = delete;
+    DoublyLinkedList& operator=(const DoublyLinkedList&) = delete;
+};
+
+// SmallDoublyLinkedList – the first N nodes live inside the list object; the
+// rest spill to Fallback (the usual node pool by default).
+template <typename T, std::size_t N, typename Fallback = PoolAllocator<Node<T>>>
+using SmallDoublyLinkedList = DoublyLinkedList<T, InlineAllocator<Node<T>, N, Fallback>>;
+
+/*
+ basic_iterator – bidirectional iterator over the nodes. end() is a null
+  node, so the iterator also remembers its list to step back from end()
+  to tail.
+ */
+template <typename T, typename Allocator>
+template <bool Const>
+class DoublyLinkedList<T, Allocator>::basic_iterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::conditional<Const, const T*, T*>::type;
+    using reference         = typename std::conditional<Const, const T&, T&>::type;
+
+    basic_iterator() : node(nullptr), list(nullptr) {}
+    // iterator converts to const_iterator, never the other way round.
+    template <bool C = Const, typename = typename std::enable_if<C>::type>
+    basic_iterator(const basic_iterator<false>& it) : node(it.node), list(it.list) {}
+
+    reference operator*()  const { return node->data; }
+    pointer   operator->() const { return std::addressof(node->data); }
+
+    basic_iterator& operator++() { node = node->next; return *this; }
+    basic_iterator& operator--() { node = node ? node->prev : list->tail; return *this; }
+    basic_iterator  operator++(int) { basic_iterator t = *this; ++*this; return t; }
+    basic_iterator  operator--(int) { basic_iterator t = *this; --*this; return t; }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.node == b.node; }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b) { return a.node != b.node; }
+
+private:
+    friend class DoublyLinkedList;
+    friend class basic_iterator<!Const>;
+
+    node_type*              node;
+    const DoublyLinkedList* list;
+
+    basic_iterator(node_type* n, const DoublyLinkedList* l) : node(n), list(l) {}
+};
+
+// basic_streaming_iterator – forward iterator that prefetches ahead.
+template <typename T, typename Allocator>
+template <bool Const>
+class DoublyLinkedList<T, Allocator>::basic_streaming_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::conditional<Const, const T*, T*>::type;
+    using reference         = typename std::conditional<Const, const T&, T&>::type;
+
+    basic_streaming_iterator() = default;
+
+    reference operator*()  const { return walk.get()->data; }
+    pointer   operator->() const { return std::addressof(walk.get()->data); }
+
+    basic_streaming_iterator& operator++() { walk.advance(); return *this; }
+    basic_streaming_iterator  operator++(int) { basic_streaming_iterator t = *this; ++*this; return t; }
+
+    friend bool operator==(const basic_streaming_iterator& a, const basic_streaming_iterator& b) {
+        return a.walk.get() == b.walk.get();
+    }
+    friend bool operator!=(const basic_streaming_iterator& a, const basic_streaming_iterator& b) {
+        return !(a == b);
+    }
+
+private:
+    friend class DoublyLinkedList;
+
+    dll_prefetch::Lookahead<node_type, &node_type::next> walk;
+
+    explicit basic_streaming_iterator(node_type* n) : walk(n) {}
+};
+
+/*
+ Destructor – run element destructors (skipped for trivial T), then hand
+  the whole chain back to the allocator at once.
+  O(1) for the pool allocators with trivial T, O(n) otherwise.
+ */
+template <typename T, typename Allocator>
+DoublyLinkedList<T, Allocator>::~DoublyLinkedList() {
+    clear();
+}
+
+template <typename T, typename Allocator>
+DoublyLinkedList<T, Allocator>&
+DoublyLinkedList<T, Allocator>::operator=(DoublyLinkedList&& other) noexcept(nothrow_relocate) {
+    if (this != &other) {
+        clear();              // our nodes go back to our own allocator first
+        alloc = std::move(other.alloc);
+        steal(other);
+    }
+    return *this;
+}
+
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::clear() noexcept {
+    if (!std::is_trivially_destructible<T>::value)
+        for (node_type* cur = head; cur; cur = cur->next)
+            cur->data.~T();
+    alloc.deallocate_chain(head, tail);
+    head = tail = nullptr;
+    size_ = 0;
+}
+
+// steal – take other's chain as ours (we must be empty); other ends empty.
+// alloc must already have taken over other's; inline nodes move with it.
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::steal(DoublyLinkedList& other) {
+    head  = other.head;
+    tail  = other.tail;
+    size_ = other.size_;
+    other.head = other.tail = nullptr;
+    other.size_ = 0;
+    if constexpr (has_inline_storage<Allocator>::value) alloc.relocate_from(other.alloc, head, tail);
+}
+
+/*
+ make_node / destroy_node – the only places that touch the allocator for a
+  single element. If T's constructor throws the node goes straight back.
+ */
+template <typename T, typename Allocator>
+template <typename... Args>
+Node<T>* DoublyLinkedList<T, Allocator>::make_node(Args&&... args) {
+    DLL_STAT(node_allocs, 1);
+    node_type* n = new (alloc.allocate()) node_type();
+    try {
+        ::new (static_cast<void*>(std::addressof(n->data))) T(std::forward<Args>(args)...);
+    } catch (...) {
+        alloc.deallocate(n);
+        throw;
+    }
+    return n;
+}
+
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::destroy_node(node_type* n) {
+    n->data.~T();
+    alloc.deallocate(n);
+}
+
+
+template <typename T, typename Allocator>
+template <typename... Args>
+T& DoublyLinkedList<T, Allocator>::emplace_front(Args&&... args) {
+    node_type* n = make_node(std::forward<Args>(args)...);
+    n->next = head;         // new node points forward
+    if (head) head->prev = n;
+    head = n;
+    if (!tail) tail = n;    // list was empty
+    ++size_;
+    DLL_STAT(push_front, 1);
+    DLL_STAT_SIZE(size_);
+    return n->data;
+}
+
+/*
+ emplace_back – append a new value in symmetric fashion.
+ */
+template <typename T, typename Allocator>
+template <typename... Args>
+T& DoublyLinkedList<T, Allocator>::emplace_back(Args&&... args) {
+    node_type* n = make_node(std::forward<Args>(args)...);
+    n->prev = tail;
+    if (tail) tail->next = n;
+    tail = n;
+    if (!head) head = n;
+    ++size_;
+    DLL_STAT(push_back, 1);
+    DLL_STAT_SIZE(size_);
+    return n->data;
+}
+
+
+template <typename T, typename Allocator>
+T DoublyLinkedList<T, Allocator>::pop_front() {
+    if (empty()) {
+        DLL_STAT(empty_pops, 1);
+        throw std::underflow_error("pop_front on empty list");
+    }
+    return take_front();
+}
+
+template <typename T, typename Allocator>
+T DoublyLinkedList<T, Allocator>::pop_back() {
+    if (empty()) {
+        DLL_STAT(empty_pops, 1);
+        throw std::underflow_error("pop_back on empty list");
+    }
+    return take_back();
+}
+
+template <typename T, typename Allocator>
+std::optional<T> DoublyLinkedList<T, Allocator>::try_pop_front() {
+    if (empty()) {
+        DLL_STAT(empty_pops, 1);
+        return std::nullopt;
+    }
+    return take_front();
+}
+
+template <typename T, typename Allocator>
+std::optional<T> DoublyLinkedList<T, Allocator>::try_pop_back() {
+    if (empty()) {
+        DLL_STAT(empty_pops, 1);
+        return std::nullopt;
+    }
+    return take_back();
+}
+
+// take_front / take_back – unchecked pops shared by the throwing and try_ forms.
+template <typename T, typename Allocator>
+T DoublyLinkedList<T, Allocator>::take_front() {
+    DLL_STAT(pop_front, 1);
+    node_type* n = head;
+    T          val(std::move(n->data));
+    head = head->next;
+    if (head) head->prev = nullptr;
+    else      tail = nullptr;  // list became empty
+    destroy_node(n);
+    --size_;
+    return val;
+}
+
+template <typename T, typename Allocator>
+T DoublyLinkedList<T, Allocator>::take_back() {
+    DLL_STAT(pop_back, 1);
+    node_type* n = tail;
+    T          val(std::move(n->data));
+    tail = tail->prev;
+    if (tail) tail->next = nullptr;
+    else      head = nullptr;
+    destroy_node(n);
+    --size_;
+    return val;
+}
+
+/*
+ pop_front_n / pop_back_n – move values out while walking, then cut the
+  drained run off in one relink. If writing to out throws, the elements
+  already moved are still cut off, so the list stays consistent.
+ */
+template <typename T, typename Allocator>
+template <typename OutputIt>
+std::size_t DoublyLinkedList<T, Allocator>::pop_front_n(OutputIt out, std::size_t n) {
+    node_type*  first = head;
+    node_type*  cur   = head;
+    std::size_t done  = 0;
+    auto cut = [&] {
+        if (!done) return;
+        node_type* last = cur ? cur->prev : tail;
+        head = cur;
+        if (head) head->prev = nullptr;
+        else      tail = nullptr;
+        size_ -= done;
+        DLL_STAT(pop_front, done);
+        alloc.deallocate_chain(first, last);
+    };
+    try {
+        for (; cur && done < n; cur = cur->next, ++done) {
+            *out = std::move(cur->data);
+            ++out;
+            cur->data.~T();
+        }
+    } catch (...) {
+        cut();
+        throw;
+    }
+    cut();
+    return done;
+}
+
+template <typename T, typename Allocator>
+template <typename OutputIt>
+std::size_t DoublyLinkedList<T, Allocator>::pop_back_n(OutputIt out, std::size_t n) {
+    node_type*  last = tail;
+    node_type*  cur  = tail;
+    std::size_t done = 0;
+    auto cut = [&] {
+        if (!done) return;
+        node_type* first = cur ? cur->next : head;
+        tail = cur;
+        if (tail) tail->next = nullptr;
+        else      head = nullptr;
+        size_ -= done;
+        DLL_STAT(pop_back, done);
+        alloc.deallocate_chain(first, last);
+    };
+    try {
+        for (; cur && done < n; cur = cur->prev, ++done) {
+            *out = std::move(cur->data);
+            ++out;
+            cur->data.~T();
+        }
+    } catch (...) {
+        cut();
+        throw;
+    }
+    cut();
+    return done;
+}
+
+/*
+ emplace / erase – O(1) link and unlink around an iterator position.
+ */
+template <typename T, typename Allocator>
+template <typename... Args>
+typename DoublyLinkedList<T, Allocator>::iterator
+DoublyLinkedList<T, Allocator>::emplace(const_iterator pos, Args&&... args) {
+    node_type* n      = make_node(std::forward<Args>(args)...);
+    node_type* at     = pos.node;            // insert before this; null is end()
+    node_type* before = at ? at->prev : tail;
+    n->prev = before;
+    n->next = at;
+    if (before) before->next = n;
+    else        head = n;
+    if (at) at->prev = n;
+    else    tail = n;
+    ++size_;
+    DLL_STAT_SIZE(size_);
+    return iterator(n, this);
+}
+
+template <typename T, typename Allocator>
+typename DoublyLinkedList<T, Allocator>::iterator
+DoublyLinkedList<T, Allocator>::erase(const_iterator pos) {
+    node_type* n    = pos.node;
+    node_type* next = n->next;
+    if (n->prev) n->prev->next = next;
+    else         head = next;
+    if (next) next->prev = n->prev;
+    else      tail = n->prev;
+    destroy_node(n);
+    --size_;
+    return iterator(next, this);
+}
+
+template <typename T, typename Allocator>
+typename DoublyLinkedList<T, Allocator>::iterator
+DoublyLinkedList<T, Allocator>::erase(const_iterator first, const_iterator last) {
+    while (first != last) first = erase(first);
+    return iterator(last.node, this);
+}
+
+/*
+ build_chain – construct nodes for [first, last) linked only to each other.
+  On an exception everything built so far, and any unused part of the
+  pool run, goes back to the allocator before rethrowing.
+ */
+template <typename T, typename Allocator>
+template <typename InputIt>
+std::size_t DoublyLinkedList<T, Allocator>::build_chain(InputIt first, InputIt last,
+                                                        node_type*& chain_head,
+                                                        node_type*& chain_tail) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    chain_head = chain_tail = nullptr;
+    node_type*  run      = nullptr;
+    std::size_t run_left = 0;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+        run_left = static_cast<std::size_t>(std::distance(first, last));
+        run      = static_cast<node_type*>(alloc.allocate_run(run_left));
+        if (!run) run_left = 0;
+    }
+
+    std::size_t n = 0;
+    try {
+        for (; first != last; ++first) {
+            node_type* nd;
+            if (run_left) {
+                nd = new (run++) node_type();
+                --run_left;
+            } else {
+                nd = new (alloc.allocate()) node_type();
+            }
+            try {
+                ::new (static_cast<void*>(std::addressof(nd->data))) T(*first);
+            } catch (...) {
+                alloc.deallocate(nd);
+                throw;
+            }
+            nd->prev = chain_tail;
+            if (chain_tail) chain_tail->next = nd;
+            else            chain_head = nd;
+            chain_tail = nd;
+            ++n;
+        }
+    } catch (...) {
+        for (; run_left; --run_left) alloc.deallocate(new (run++) node_type());
+        for (node_type* cur = chain_head; cur;) {
+            node_type* next = cur->next;
+            destroy_node(cur);
+            cur = next;
+        }
+        throw;
+    }
+    return n;
+}
+
+template <typename T, typename Allocator>
+template <typename InputIt>
+typename DoublyLinkedList<T, Allocator>::iterator
+DoublyLinkedList<T, Allocator>::insert_range(const_iterator pos, InputIt first, InputIt last) {
+    node_type*  chain_head;
+    node_type*  chain_tail;
+    std::size_t n = build_chain(first, last, chain_head, chain_tail);
+    if (!n) return iterator(pos.node, this);
+    DLL_STAT(node_allocs, n);
+
+    node_type* at     = pos.node;
+    node_type* before = at ? at->prev : tail;
+    chain_head->prev = before;
+    chain_tail->next = at;
+    if (before) before->next = chain_head;
+    else        head = chain_head;
+    if (at) at->prev = chain_tail;
+    else    tail = chain_tail;
+    size_ += n;
+    DLL_STAT_SIZE(size_);
+    return iterator(chain_head, this);
+}
+
+template <typename T, typename Allocator>
+template <typename InputIt>
+void DoublyLinkedList<T, Allocator>::assign(InputIt first, InputIt last) {
+    iterator cur = begin();
+    for (; cur != end() && first != last; ++cur, ++first) *cur = *first;
+    if (first != last) append_range(first, last);
+    else               erase(cur, end());
+}
+
+/*
+ splice – O(1) relink once the allocators agree that our allocator can free
+  other's nodes. If they can't (e.g. two SharedPool lists on different
+  arenas) the elements are moved across one at a time instead.
+ */
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::splice(const_iterator pos, DoublyLinkedList& other) {
+    if (this == &other || other.empty()) return;
+    if (!alloc.absorb(other.alloc)) {
+        while (!other.empty()) emplace(pos, other.pop_front());
+        return;
+    }
+    node_type* at     = pos.node;
+    node_type* before = at ? at->prev : tail;
+    other.head->prev = before;
+    other.tail->next = at;
+    if (before) before->next = other.head;
+    else        head = other.head;
+    if (at) at->prev = other.tail;
+    else    tail = other.tail;
+    size_ += other.size_;
+    DLL_STAT_SIZE(size_);
+    other.head = other.tail = nullptr;
+    other.size_ = 0;
+}
+
+/*
+ merge – walk both sorted chains once, relinking the smaller head each step.
+  Ties keep this list's element first, so the merge is stable. O(n + m).
+ */
+template <typename T, typename Allocator>
+template <typename Compare>
+void DoublyLinkedList<T, Allocator>::merge(DoublyLinkedList& other, Compare comp) {
+    if (this == &other || other.empty()) return;
+    if (!alloc.absorb(other.alloc)) {
+        // Nodes can't change hands: move other's elements in at their places.
+        const_iterator at = cbegin();
+        while (!other.empty()) {
+            while (at != cend() && !comp(other.front(), *at)) ++at;
+            emplace(at, other.take_front());
+        }
+        return;
+    }
+
+    node_type* a     = head;
+    node_type* b     = other.head;
+    node_type* first = nullptr;
+    node_type* last  = nullptr;
+    while (a && b) {
+        node_type*& src = comp(b->data, a->data) ? b : a;
+        node_type*  n   = src;
+        src     = src->next;
+        n->prev = last;
+        if (last) last->next = n;
+        else      first = n;
+        last = n;
+    }
+    node_type* rest = a ? a : b;   // at most one chain still has nodes
+    rest->prev = last;
+    if (last) last->next = rest;
+    else      first = rest;
+
+    head   = first;
+    tail   = a ? tail : other.tail;
+    size_ += other.size_;
+    DLL_STAT_SIZE(size_);
+    other.head = other.tail = nullptr;
+    other.size_ = 0;
+}
+
+/*
+ split_at – find the k-th node from whichever end is closer and cut there.
+  The returned list shares our allocator, so no node is copied; with the
+  default PoolAllocator that means one NodePool, and both lists must stay on
+  one thread. Splicing rest into a fresh list moves its elements out while
+  the pool is shared, after which that list is independent.
+ */
+template <typename T, typename Allocator>
+DoublyLinkedList<T, Allocator> DoublyLinkedList<T, Allocator>::split_at(std::size_t k) {
+    if (k > size_) throw std::out_of_range("split_at past end of list");
+    DoublyLinkedList rest(alloc);
+    if (k == size_) return rest;
+    if (!rest.alloc.absorb(alloc)) {   // our nodes can't move to rest (inline storage)
+        while (size_ > k) rest.emplace_front(take_back());
+        return rest;
+    }
+
+    node_type* cut = head;         // first node of the returned part
+    if (k <= size_ / 2) {
+        for (std::size_t i = 0; i < k; ++i) cut = cut->next;
+    } else {
+        cut = tail;
+        for (std::size_t i = size_ - 1; i > k; --i) cut = cut->prev;
+    }
+    cut_before(cut, k, rest);
+    return rest;
+}
+
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::cut_before(node_type* cut, std::size_t k,
+                                                DoublyLinkedList& rest) noexcept {
+    rest.head  = cut;
+    rest.tail  = tail;
+    rest.size_ = size_ - k;
+    tail = cut->prev;
+    if (tail) tail->next = nullptr;
+    else      head = nullptr;
+    cut->prev = nullptr;
+    size_     = k;
+}
+
+/*
+ sort – hand the forward chain to dll_sort::sort_chain, then rebuild prev
+  and tail in one pass. If comp throws, every node is still in the list
+  but their order is unspecified.
+ */
+template <typename T, typename Allocator>
+template <typename Compare>
+void DoublyLinkedList<T, Allocator>::sort(Compare comp) {
+    if (size_ < 2) return;
+    node_type* first = head;
+    auto relink = [&] {
+        node_type* prev = nullptr;
+        for (node_type* n = first; n; n = n->next) {
+            n->prev = prev;
+            prev    = n;
+        }
+        head = first;
+        tail = prev;
+    };
+    try {
+        dll_sort::sort_chain(first, static_cast<node_type*>(nullptr),
+                             [](node_type* n) -> node_type*& { return n->next; },
+                             [&](node_type* a, node_type* b) { return comp(a->data, b->data); });
+    } catch (...) {
+        relink();
+        throw;
+    }
+    relink();
+}
+
+template <typename T, typename Allocator>
+template <typename BinaryPred>
+std::size_t DoublyLinkedList<T, Allocator>::unique(BinaryPred pred) {
+    std::size_t removed = 0;
+    if (!head) return removed;
+    for (iterator kept = begin(), it = std::next(kept); it != end();) {
+        if (pred(*kept, *it)) {
+            it = erase(it);
+            ++removed;
+        } else {
+            kept = it++;
+        }
+    }
+    return removed;
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+typename DoublyLinkedList<T, Allocator>::iterator
+DoublyLinkedList<T, Allocator>::insert_sorted(T value, Compare comp) {
+    if (!head || !comp(value, tail->data)) return emplace(cend(), std::move(value));
+    const_iterator at = cbegin();
+    while (!comp(value, *at)) ++at;   // stops at tail at the latest
+    return emplace(at, std::move(value));
+}
+
+/*
+ write_to – walk in the requested direction, formatting each element and a
+  separating space into the block buffer. Framed output matches the old
+  print_forward/print_backward, minus the flush.
+ */
+template <typename T, typename Allocator>
+template <typename Sink>
+void DoublyLinkedList<T, Allocator>::write_with(Sink& sink, dll_io::Direction dir,
+                                                bool framed) const {
+    bool                      fwd = dir == dll_io::Direction::forward;
+    dll_io::BlockWriter<Sink> w(sink);
+    if (framed) w.put(fwd ? "[head] " : "[tail] ");
+    for_each([&w](const T& v) {
+        w.value(v);
+        w.put(" ", 1);
+    }, dir);
+    if (framed) w.put("[null]\n", 7);
+    w.flush();
+}
+
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::write_to(std::ostream& os, dll_io::Direction dir,
+                                              bool framed) const {
+    dll_io::OstreamSink sink{os};
+    write_with(sink, dir, framed);
+}
+
+#if DLL_HAVE_POSIX_WRITE
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::write_to(int fd, dll_io::Direction dir, bool framed) const {
+    dll_io::FdSink sink{fd};
+    write_with(sink, dir, framed);
+}
+#endif
+
+/*
+ save_snapshot – header, then the values in list order, copied through a
+  staging block so the stream sees a few large writes.
+ */
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::save_snapshot(std::ostream& os) const {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots need trivially copyable T");
+    dll_snapshot::Header h = dll_snapshot::make_header<T>(dll_snapshot::Layout::values, size_);
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    dll_snapshot::Stage<T> stage(size_);
+    std::size_t            n = 0;
+    for (node_type* cur = head; cur; cur = cur->next) {
+        std::memcpy(static_cast<void*>(stage.data() + n), std::addressof(cur->data), sizeof(T));
+        if (++n == stage.size()) {
+            os.write(reinterpret_cast<const char*>(stage.data()), static_cast<std::streamsize>(n * sizeof(T)));
+            n = 0;
+        }
+    }
+    os.write(reinterpret_cast<const char*>(stage.data()), static_cast<std::streamsize>(n * sizeof(T)));
+    if (!os) throw std::runtime_error("failed to write list snapshot");
+}
+
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::load_snapshot(std::istream& is) {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots need trivially copyable T");
+    dll_snapshot::Header h;
+    dll_snapshot::read_exact(is, &h, sizeof(h));
+    dll_snapshot::check<T>(h, dll_snapshot::Layout::values);
+    is.ignore(static_cast<std::streamsize>(h.payload_offset - sizeof(h)));
+
+    dll_snapshot::Stage<T> stage(h.count);
+    for (std::uint64_t left = h.count; left;) {
+        std::size_t n = left < stage.size() ? std::size_t(left) : stage.size();
+        dll_snapshot::read_exact(is, stage.data(), n * sizeof(T));
+        append_range(stage.data(), stage.data() + n);
+        left -= n;
+    }
+}
+
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::load_snapshot(const char* path) {
+#if DLL_HAVE_POSIX_WRITE
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots need trivially copyable T");
+    dll_snapshot::MappedFile file(path);
+    dll_snapshot::check<T>(file.header(), dll_snapshot::Layout::values);
+    std::uint64_t count = file.header().count;
+    const T*      first = reinterpret_cast<const T*>(file.payload(count, sizeof(T)));
+    append_range(first, first + count);
+#else
+    std::ifstream is(path, std::ios::binary);
+    if (!is) throw std::runtime_error(std::string("cannot open ") + path);
+    load_snapshot(is);
+#endif
+}
+
+/*
+ partition – parts + 1 iterators cutting the list into runs of near-equal
+  length; the last is end().
+ */
+template <typename T, typename Allocator>
+std::vector<typename DoublyLinkedList<T, Allocator>::const_iterator>
+DoublyLinkedList<T, Allocator>::partition(std::size_t parts) const {
+    if (parts == 0) parts = 1;
+    std::vector<const_iterator> cuts;
+    cuts.reserve(parts + 1);
+    cuts.push_back(begin());
+    const node_type* cur = head;
+    for (std::size_t p = 1, i = 0; p < parts; ++p) {
+        for (std::size_t stop = size_ * p / parts; i < stop; ++i) cur = cur->next;
+        cuts.push_back(const_iterator(const_cast<node_type*>(cur), this));
+    }
+    cuts.push_back(end());
+    return cuts;
+}
+
+template <typename T, typename Allocator>
+template <typename F>
+void DoublyLinkedList<T, Allocator>::parallel_for_each(const std::vector<const_iterator>& cuts, F f) const {
+    dll_parallel::run(cuts.size() - 1, [&](std::size_t i) {
+        for (const_iterator it = cuts[i]; it != cuts[i + 1]; ++it) f(*it);
+    });
+}
+
+template <typename T, typename Allocator>
+template <typename U, typename Fold, typename Combine>
+U DoublyLinkedList<T, Allocator>::parallel_reduce(const std::vector<const_iterator>& cuts, U identity,
+                                                  Fold fold, Combine combine) const {
+    std::vector<U> partials(cuts.size() - 1, identity);
+    dll_parallel::run(partials.size(), [&](std::size_t i) {
+        U acc = identity;
+        for (const_iterator it = cuts[i]; it != cuts[i + 1]; ++it) acc = fold(std::move(acc), *it);
+        partials[i] = std::move(acc);
+    });
+    return dll_parallel::combine_all(partials, combine);
+}
+
+template <typename T, typename Allocator>
+template <typename Pred>
+std::size_t DoublyLinkedList<T, Allocator>::parallel_count_if(const std::vector<const_iterator>& cuts,
+                                                              Pred pred) const {
+    std::vector<std::size_t> counts(cuts.size() - 1);
+    dll_parallel::run(counts.size(), [&](std::size_t i) {
+        std::size_t n = 0;
+        for (const_iterator it = cuts[i]; it != cuts[i + 1]; ++it) n += pred(*it) ? 1 : 0;
+        counts[i] = n;
+    });
+    std::size_t total = 0;
+    for (std::size_t n : counts) total += n;
+    return total;
+}
+
+/* scan – for_each's walk from head or tail, prefetching the nodes ahead */
+template <typename T, typename Allocator>
+template <typename Ref, typename F>
+void DoublyLinkedList<T, Allocator>::scan(F& f, dll_io::Direction dir) const {
+    if (dir == dll_io::Direction::forward) {
+        for (dll_prefetch::Lookahead<node_type, &node_type::next> w(head); w.get(); w.advance())
+            f(static_cast<Ref>(w.get()->data));
+    } else {
+        for (dll_prefetch::Lookahead<node_type, &node_type::prev> w(tail); w.get(); w.advance())
+            f(static_cast<Ref>(w.get()->data));
+    }
+}
+
+/*
+ relayout – move (or, if moving could throw, copy) every element into a
+  fresh run of size() adjacent nodes, then free the old chain. If an
+  element throws, the run goes back and the list is left as it was.
+ */
+template <typename T, typename Allocator>
+bool DoublyLinkedList<T, Allocator>::relayout() {
+    if (!size_) return true;
+    node_type* run = static_cast<node_type*>(alloc.allocate_run(size_));
+    if (!run) return false;
+    std::size_t built = 0;
+    try {
+        for (node_type* cur = head; cur; cur = cur->next, ++built) {
+            node_type* nd = new (run + built) node_type();
+            ::new (static_cast<void*>(std::addressof(nd->data))) T(std::move_if_noexcept(cur->data));
+        }
+    } catch (...) {
+        for (std::size_t i = 0; i < size_; ++i) {
+            if (i < built) run[i].data.~T();
+            else           new (run + i) node_type();
+            run[i].next = i + 1 < size_ ? run + i + 1 : nullptr;
+        }
+        alloc.deallocate_chain(run, run + size_ - 1);
+        throw;
+    }
+    for (std::size_t i = 0; i < size_; ++i) {
+        run[i].prev = i ? run + i - 1 : nullptr;
+        run[i].next = i + 1 < size_ ? run + i + 1 : nullptr;
+    }
+    std::size_t n = size_;
+    clear();
+    head  = run;
+    tail  = run + n - 1;
+    size_ = n;
+    DLL_STAT(node_allocs, n);
+    return true;
+}
+
+/*  print_forward / print_backward –  traversals to
+ verify links
+ */
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::print_forward() const {
+    write_to(std::cout, dll_io::Direction::forward, true);
+}
+
+template <typename T, typename Allocator>
+void DoublyLinkedList<T, Allocator>::print_backward() const {
+    write_to(std::cout, dll_io::Direction::backward, true);
+}
+
+/*
+ SkipIndexedList – a DoublyLinkedList with skip-list express lanes over it,
+  for O(log n) expected at(k), insert/erase at a position, split_at(k) and
+  (on a list kept sorted) find / lower_bound / insert_sorted.
+
+  About one node in eight carries a tower; a tower reaching lane L+1 also
+  reaches lane L, with a quarter of each lane's towers going one lane up.
+  Each lane link records how many list positions it spans, so a search
+  drops down the lanes counting positions and then walks at most a few
+  nodes along the list itself. The link out of the last tower of a lane
+  stores no width: the wrapper keeps the rank of each lane's last tower
+  instead, so push_back and pop_back touch no lane unless the node has a
+  tower, and push_front / pop_front only bump two small arrays.
+
+  Freed towers are kept on per-height free lists for reuse, the way
+  NodePool keeps nodes. The nodes never move, which rules out
+  InlineAllocator lists. Values may
+  be changed through iterators, but for the sorted lookups they must stay
+  in order.
+ */
+template <typename T, typename Allocator = PoolAllocator<Node<T>>>
+class SkipIndexedList {
+public:
+    using list_type      = DoublyLinkedList<T, Allocator>;
+    using value_type     = T;
+    using iterator       = typename list_type::iterator;
+    using const_iterator = typename list_type::const_iterator;
+
+    static_assert(!has_inline_storage<Allocator>::value,
+                  "the lanes point at nodes, which inline storage relocates");
+
+    SkipIndexedList() { reset_lanes(); }
+    explicit SkipIndexedList(const Allocator& a) : list(a) { reset_lanes(); }
+    ~SkipIndexedList();
+
+    SkipIndexedList(SkipIndexedList&& other) noexcept
+        : list(std::move(other.list)) {
+        take_lanes(other);
+    }
+    SkipIndexedList& operator=(SkipIndexedList&& other) noexcept;
+
+    void push_front(const T& value) { insert_at(1, head_path(), value); }
+    void push_front(T&& value)      { insert_at(1, head_path(), std::move(value)); }
+    void push_back(const T& value)  { append(value); }
+    void push_back(T&& value)       { append(std::move(value)); }
+
+    T pop_front();
+    T pop_back();
+
+    T&       front()       { return list.front(); }
+    const T& front() const { return list.front(); }
+    T&       back()        { return list.back(); }
+    const T& back()  const { return list.back(); }
+
+    // Positional access, k counted from the front. at() throws
+    // std::out_of_range past the end; nth(size()) is end().
+    T&       at(std::size_t k)       { return *checked_nth(k); }
+    const T& at(std::size_t k) const { return *const_cast<SkipIndexedList*>(this)->checked_nth(k); }
+    iterator nth(std::size_t k);
+    iterator insert(std::size_t k, T value);     // the new element ends up at k
+    void     erase(std::size_t k);
+
+    // Keep the first k elements, return the rest with their lanes.
+    SkipIndexedList split_at(std::size_t k);
+
+    // For lists sorted by comp: first element equal to value, or end().
+    template <typename Compare> iterator find(const T& value, Compare comp);
+    iterator find(const T& value) { return find(value, std::less<T>()); }
+    // Position of the first element not less than value (size() if none).
+    template <typename Compare> std::size_t lower_bound(const T& value, Compare comp) const;
+    std::size_t lower_bound(const T& value) const { return lower_bound(value, std::less<T>()); }
+    // Insert after any equal elements. O(log n) expected.
+    template <typename Compare> iterator insert_sorted(T value, Compare comp);
+    iterator insert_sorted(T value) { return insert_sorted(std::move(value), std::less<T>()); }
+
+    void clear() noexcept;
+
+    iterator       begin()       { return list.begin(); }
+    iterator       end()         { return list.end(); }
+    const_iterator begin() const { return list.begin(); }
+    const_iterator end()   const { return list.end(); }
+
+    // Read-only view of the underlying list, e.g. for its parallel scans.
+    const list_type& base() const { return list; }
+
+    std::size_t size() const  { return list.size(); }
+    bool        empty() const { return list.empty(); }
+    void        print_forward()  const { list.print_forward(); }
+    void        print_backward() const { list.print_backward(); }
+
+private:
+    using node_type = typename list_type::node_type;
+    static constexpr unsigned max_lanes = 16;   // 8 * 4^15 nodes before towers top out
+
+    struct Tower;
+    struct Link {
+        Tower*      next;
+        std::size_t width;   // ranks from this tower to next; unused when next is null
+    };
+    // Rank 0 is the head sentinel, the list's nodes are ranks 1..size().
+    struct Tower {
+        node_type* base;
+        unsigned   height;
+        Link*      lane;
+    };
+    // Per lane, the last tower before the position being changed. Only
+    // lane 0 and lanes [0, lanes) are filled in; the rest are empty anyway.
+    struct Path {
+        Tower*      at[max_lanes];
+        std::size_t rank[max_lanes];
+    };
+
+    list_type     list;
+    Tower         head;
+    Link          head_lanes[max_lanes];
+    Tower*        last[max_lanes];        // last tower on each lane (head if none)
+    std::size_t   last_rank[max_lanes];
+    unsigned      lanes = 0;              // lanes [0, lanes) hold at least one tower
+    Tower*        spare[max_lanes] = {};  // free towers by height - 1, linked through lane[0]
+    std::uint64_t rng   = 0x9E3779B97F4A7C15ull;
+
+    void reset_lanes() noexcept;
+    void take_lanes(SkipIndexedList& other) noexcept;
+    void free_towers() noexcept;
+    unsigned      draw_height() noexcept;
+    Tower*        make_tower(unsigned height);
+    void          free_tower(Tower* t) noexcept {
+        t->lane[0].next       = spare[t->height - 1];
+        spare[t->height - 1] = t;
+    }
+
+    Path head_path() noexcept;
+    Path tail_path() noexcept;
+    template <typename Before> Path descend(Before before);
+    Path rank_path(std::size_t r) {
+        return descend([r](Tower*, std::size_t next_rank) { return next_rank < r; });
+    }
+    node_type* walk(const Path& p, std::size_t r) const;
+    iterator   checked_nth(std::size_t k);
+
+    template <typename V> iterator insert_at(std::size_t r, const Path& p, unsigned h, V&& value);
+    template <typename V> iterator insert_at(std::size_t r, const Path& p, V&& value) {
+        return insert_at(r, p, draw_height(), std::forward<V>(value));
+    }
+    template <typename V> iterator append(V&& value);
+    void       link_tower(Tower* t, std::size_t r, const Path& p) noexcept;
+    void       erase_at(node_type* n, std::size_t r, const Path& p) noexcept;
+
+    SkipIndexedList(const SkipIndexedList&)            = delete;
+    SkipIndexedList& operator=(const SkipIndexedList&) = delete;
+};
+
+template <typename T, typename Allocator>
+SkipIndexedList<T, Allocator>::~SkipIndexedList() {
+    free_towers();
+    for (Tower* t : spare)
+        while (t) {
+            Tower* n = t->lane[0].next;
+            ::operator delete(t);
+            t = n;
+        }
+}
+
+template <typename T, typename Allocator>
+void SkipIndexedList<T, Allocator>::reset_lanes() noexcept {
+    head.base   = nullptr;
+    head.height = max_lanes;
+    head.lane   = head_lanes;
+    for (unsigned l = 0; l < max_lanes; ++l) {
+        head_lanes[l] = Link{nullptr, 0};
+        last[l]       = &head;
+        last_rank[l]  = 0;
+    }
+    lanes = 0;
+}
+
+// take_lanes – adopt other's towers; only links to other's head need fixing.
+template <typename T, typename Allocator>
+void SkipIndexedList<T, Allocator>::take_lanes(SkipIndexedList& other) noexcept {
+    reset_lanes();
+    for (unsigned l = 0; l < other.lanes; ++l) {
+        head_lanes[l] = other.head_lanes[l];
+        last[l]       = other.last[l] == &other.head ? &head : other.last[l];
+        last_rank[l]  = other.last_rank[l];
+    }
+    lanes = other.lanes;
+    rng   = other.rng;
+    other.reset_lanes();
+}
+
+template <typename T, typename Allocator>
+SkipIndexedList<T, Allocator>& SkipIndexedList<T, Allocator>::operator=(SkipIndexedList&& other) noexcept {
+    if (this != &other) {
+        free_towers();
+        list = std::move(other.list);
+        take_lanes(other);
+    }
+    return *this;
+}
+
+template <typename T, typename Allocator>
+void SkipIndexedList<T, Allocator>::free_towers() noexcept {
+    for (Tower* t = head_lanes[0].next; t;) {
+        Tower* n = t->lane[0].next;
+        free_tower(t);
+        t = n;
+    }
+    reset_lanes();
+}
+
+template <typename T, typename Allocator>
+void SkipIndexedList<T, Allocator>::clear() noexcept {
+    free_towers();
+    list.clear();
+}
+
+// draw_height – 0 (no tower) seven times in eight, then one more lane per
+// two zero bits, from one xorshift step.
+template <typename T, typename Allocator>
+unsigned SkipIndexedList<T, Allocator>::draw_height() noexcept {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    std::uint64_t r = rng;
+    if (r & 7) return 0;
+    unsigned h = 1;
+    for (r >>= 3; h < max_lanes && (r & 3) == 0; r >>= 2) ++h;
+    return h;
+}
+
+// make_tower – a spare of the right height, else one allocation holding
+// the header and then its height links.
+template <typename T, typename Allocator>
+typename SkipIndexedList<T, Allocator>::Tower* SkipIndexedList<T, Allocator>::make_tower(unsigned height) {
+    if (Tower* t = spare[height - 1]) {
+        spare[height - 1] = t->lane[0].next;
+        for (unsigned l = 0; l < height; ++l) t->lane[l] = Link{nullptr, 0};
+        return t;
+    }
+    void* raw = ::operator new(sizeof(Tower) + height * sizeof(Link));
+    Link* lane = reinterpret_cast<Link*>(static_cast<char*>(raw) + sizeof(Tower));
+    for (unsigned l = 0; l < height; ++l) new (lane + l) Link{nullptr, 0};
+    return new (raw) Tower{nullptr, height, lane};
+}
+
+template <typename T, typename Allocator>
+typename SkipIndexedList<T, Allocator>::Path SkipIndexedList<T, Allocator>::head_path() noexcept {
+    Path p;
+    for (unsigned l = 0; l < lanes || l == 0; ++l) {
+        p.at[l]   = &head;
+        p.rank[l] = 0;
+    }
+    return p;
+}
+
+// tail_path – the path to one past the back: every lane's last tower.
+template <typename T, typename Allocator>
+typename SkipIndexedList<T, Allocator>::Path SkipIndexedList<T, Allocator>::tail_path() noexcept {
+    Path p;
+    for (unsigned l = 0; l < lanes || l == 0; ++l) {
+        p.at[l]   = last[l];
+        p.rank[l] = last_rank[l];
+    }
+    return p;
+}
+
+/*
+ descend – from the top lane down, advance while before(next tower, its
+  rank) holds. Lanes above `lanes` are empty, so they keep the head.
+ */
+template <typename T, typename Allocator>
+template <typename Before>
+typename SkipIndexedList<T, Allocator>::Path SkipIndexedList<T, Allocator>::descend(Before before) {
+    Path        p;
+    Tower*      t = &head;
+    std::size_t r = 0;
+    p.at[0]   = t;
+    p.rank[0] = r;
+    for (unsigned l = lanes; l-- > 0;) {
+        for (Tower* n; (n = t->lane[l].next) != nullptr;) {
+            std::size_t nr = r + t->lane[l].width;
+            if (!before(n, nr)) break;
+            t = n;
+            r = nr;
+        }
+        p.at[l]   = t;
+        p.rank[l] = r;
+    }
+    return p;
+}
+
+// walk – the node at rank r, at most a lane-0 gap past p's bottom tower.
+template <typename T, typename Allocator>
+typename SkipIndexedList<T, Allocator>::node_type*
+SkipIndexedList<T, Allocator>::walk(const Path& p, std::size_t r) const {
+    node_type* n = p.at[0] == &head ? list.head : p.at[0]->base;
+    for (std::size_t i = p.at[0] == &head ? 1 : p.rank[0]; i < r; ++i) n = n->next;
+    return n;
+}
+
+template <typename T, typename Allocator>
+typename SkipIndexedList<T, Allocator>::iterator SkipIndexedList<T, Allocator>::nth(std::size_t k) {
+    if (k >= list.size_) return end();
+    if (k + 1 == list.size_) return list.make_iterator(list.tail);
+    return list.make_iterator(walk(rank_path(k + 2), k + 1));
+}
+
+template <typename T, typename Allocator>
+typename SkipIndexedList<T, Allocator>::iterator SkipIndexedList<T, Allocator>::checked_nth(std::size_t k) {
+    if (k >= list.size_) throw std::out_of_range("SkipIndexedList index out of range");
+    return nth(k);
+}
+
+/*
+ insert_at – give the new element rank r, where p is rank_path(r), and a
+  tower of height h (none for 0): build the tower and the node first, so a
+  throw leaves nothing half-linked.
+ */
+template <typename T, typename Allocator>
+template <typename V>
+typename SkipIndexedList<T, Allocator>::iterator
+SkipIndexedList<T, Allocator>::insert_at(std::size_t r, const Path& p, unsigned h, V&& value) {
+    Tower*   t = h ? make_tower(h) : nullptr;
+    iterator it;
+    try {
+        node_type* at = r > list.size_ ? nullptr : walk(p, r);
+        it = list.emplace(list.make_iterator(at), std::forward<V>(value));
+    } catch (...) {
+        if (t) free_tower(t);
+        throw;
+    }
+    // Everything from rank r on moves one place back.
+    for (unsigned l = 0; l < lanes; ++l) {
+        if (p.at[l]->lane[l].next) p.at[l]->lane[l].width += 1;
+        if (last_rank[l] >= r) last_rank[l] += 1;
+    }
+    if (t) {
+        t->base = list_type::node_of(it);
+        link_tower(t, r, p);
+    }
+    return it;
+}
+
+// append – a node without a tower past every lane's end changes no lane.
+template <typename T, typename Allocator>
+template <typename V>
+typename SkipIndexedList<T, Allocator>::iterator SkipIndexedList<T, Allocator>::append(V&& value) {
+    unsigned h = draw_height();
+    if (!h) {
+        list.emplace_back(std::forward<V>(value));
+        return list.make_iterator(list.tail);
+    }
+    return insert_at(list.size_ + 1, tail_path(), h, std::forward<V>(value));
+}
+
+template <typename T, typename Allocator>
+void SkipIndexedList<T, Allocator>::link_tower(Tower* t, std::size_t r, const Path& p) noexcept {
+    for (unsigned l = 0; l < t->height; ++l) {
+        Tower*      pred = l < lanes ? p.at[l] : &head;
+        std::size_t pr   = l < lanes ? p.rank[l] : 0;
+        Link&       in   = pred->lane[l];
+        if (in.next) {
+            t->lane[l] = Link{in.next, pr + in.width - r};
+        } else {
+            last[l]      = t;
+            last_rank[l] = r;
+        }
+        in = Link{t, r - pr};
+    }
+    if (t->height > lanes) lanes = t->height;
+}
+
+/*
+ erase_at – drop n, the node at rank r (p is rank_path(r)): unhook its
+  tower, if it has one, and close the gap n leaves in every lane.
+ */
+template <typename T, typename Allocator>
+void SkipIndexedList<T, Allocator>::erase_at(node_type* n, std::size_t r, const Path& p) noexcept {
+    Tower* t = p.at[0]->lane[0].next;
+    if (!t || t->base != n) t = nullptr;
+    for (unsigned l = 0; l < lanes; ++l) {
+        Tower* pred = p.at[l];
+        Link&  in   = pred->lane[l];
+        if (t && l < t->height) {
+            if (t->lane[l].next) {
+                in = Link{t->lane[l].next, in.width + t->lane[l].width - 1};
+            } else {
+                in = Link{nullptr, 0};
+                last[l]      = pred;
+                last_rank[l] = p.rank[l];
+            }
+        } else if (in.next) {
+            in.width -= 1;
+        }
+        if (last_rank[l] > r) last_rank[l] -= 1;
+    }
+    while (lanes > 0 && !head_lanes[lanes - 1].next) --lanes;
+    if (t) free_tower(t);
+    list.erase(list.make_iterator(n));
+}
+
+template <typename T, typename Allocator>
+T SkipIndexedList<T, Allocator>::pop_front() {
+    if (empty()) throw std::underflow_error("pop_front on empty list");
+    if (lanes == 0 || head_lanes[0].width != 1) {
+        // No tower on the front node: every lane just starts one rank sooner.
+        for (unsigned l = 0; l < lanes; ++l) {
+            head_lanes[l].width -= 1;
+            last_rank[l]        -= 1;
+        }
+        return list.pop_front();
+    }
+    T val(std::move(list.front()));
+    erase_at(list.head, 1, head_path());
+    return val;
+}
+
+template <typename T, typename Allocator>
+T SkipIndexedList<T, Allocator>::pop_back() {
+    if (empty()) throw std::underflow_error("pop_back on empty list");
+    std::size_t r = list.size_;
+    // Unless the back node carries a tower, the lanes end before it.
+    if (last_rank[0] != r) return list.pop_back();
+    T val(std::move(list.back()));
+    erase_at(list.tail, r, rank_path(r));
+    return val;
+}
+
+template <typename T, typename Allocator>
+typename SkipIndexedList<T, Allocator>::iterator SkipIndexedList<T, Allocator>::insert(std::size_t k, T value) {
+    if (k > list.size_) throw std::out_of_range("SkipIndexedList insert past end");
+    if (k == list.size_) return append(std::move(value));
+    return insert_at(k + 1, rank_path(k + 1), std::move(value));
+}
+
+template <typename T, typename Allocator>
+void SkipIndexedList<T, Allocator>::erase(std::size_t k) {
+    if (k >= list.size_) throw std::out_of_range("SkipIndexedList erase past end");
+    Path p = rank_path(k + 1);
+    erase_at(walk(p, k + 1), k + 1, p);
+}
+
+/*
+ split_at – cut every lane after its last tower of rank <= k; the towers
+  past the cut become rest's lanes with their ranks shifted down by k.
+ */
+template <typename T, typename Allocator>
+SkipIndexedList<T, Allocator> SkipIndexedList<T, Allocator>::split_at(std::size_t k) {
+    if (k > list.size_) throw std::out_of_range("split_at past end of list");
+    SkipIndexedList rest(list.alloc);
+    if (k == list.size_) return rest;
+    rest.list.alloc.absorb(list.alloc);   // copies of one allocator always agree
+
+    Path p = rank_path(k + 1);
+    for (unsigned l = 0; l < lanes; ++l) {
+        Link& in = p.at[l]->lane[l];
+        if (!in.next) continue;
+        rest.head_lanes[l] = Link{in.next, p.rank[l] + in.width - k};
+        rest.last[l]       = last[l];
+        rest.last_rank[l]  = last_rank[l] - k;
+        in           = Link{nullptr, 0};
+        last[l]      = p.at[l];
+        last_rank[l] = p.rank[l];
+    }
+    rest.lanes = lanes;
+    while (rest.lanes > 0 && !rest.head_lanes[rest.lanes - 1].next) --rest.lanes;
+    while (lanes > 0 && !head_lanes[lanes - 1].next) --lanes;
+    list.cut_before(walk(p, k + 1), k, rest.list);
+    return rest;
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+typename SkipIndexedList<T, Allocator>::iterator
+SkipIndexedList<T, Allocator>::find(const T& value, Compare comp) {
+    std::size_t k = lower_bound(value, comp);
+    iterator    it = nth(k);
+    return it != end() && !comp(value, *it) ? it : end();
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+std::size_t SkipIndexedList<T, Allocator>::lower_bound(const T& value, Compare comp) const {
+    auto& self = const_cast<SkipIndexedList&>(*this);
+    Path  p    = self.descend([&](Tower* t, std::size_t) { return comp(t->base->data, value); });
+    std::size_t r = p.rank[0] + 1;
+    for (node_type* n = p.at[0] == &head ? list.head : p.at[0]->base->next;
+         n && comp(n->data, value); n = n->next)
+        ++r;
+    return r - 1;
+}
+
+template <typename T, typename Allocator>
+template <typename Compare>
+typename SkipIndexedList<T, Allocator>::iterator
+SkipIndexedList<T, Allocator>::insert_sorted(T value, Compare comp) {
+    if (empty() || !comp(value, list.back())) return append(std::move(value));
+    Path p = descend([&](Tower* t, std::size_t) { return !comp(value, t->base->data); });
+    std::size_t r = p.rank[0] + 1;
+    for (node_type* n = p.at[0] == &head ? list.head : p.at[0]->base->next;
+         !comp(value, n->data); n = n->next)   // stops at the back at the latest
+        ++r;
+    return insert_at(r, p, std::move(value));
+}
+
+/*
+ XorNode – node of an XorLinkedList: one link word holding prev ^ next.
+  While the node sits free in a NodePool the same word is the pool's `next`
+  link, so the pool allocators work unchanged. Node<int> is 24 bytes,
+  XorNode<int> is 16.
+ */
+template <typename T>
+struct XorNode {
+    union { T data; };
+    union {
+        std::uintptr_t link;   // address of prev ^ address of next, in a list
+        XorNode*       next;   // free-list link, in a pool
+    };
+
+    XorNode() : link(0) {}
+    ~XorNode() {}
+};
+
+/*
+ XorLinkedList – compact two-ended list with one link per node. Knowing
+  two neighbouring nodes is enough to step either way, so pushes, pops and
+  bidirectional traversal from either end all work as in DoublyLinkedList;
+  reverse() is O(1). What is given up is inserting or erasing at an
+  arbitrary node, and clear() must walk the list to thread the nodes for
+  the allocator (O(n) instead of O(1)).
+ */
+template <typename T, typename Allocator = PoolAllocator<XorNode<T>>>
+class XorLinkedList {
+public:
+    using value_type = T;
+    using node_type  = XorNode<T>;
+
+    template <bool Const> class basic_iterator;
+    using iterator               = basic_iterator<false>;
+    using const_iterator         = basic_iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    XorLinkedList() : head(nullptr), tail(nullptr), size_(0) {}
+    explicit XorLinkedList(const Allocator& a) : head(nullptr), tail(nullptr), size_(0), alloc(a) {}
+    ~XorLinkedList() { clear(); }
+
+    XorLinkedList(XorLinkedList&& other) noexcept
+        : head(other.head), tail(other.tail), size_(other.size_), alloc(std::move(other.alloc)) {
+        other.head = other.tail = nullptr;
+        other.size_ = 0;
+    }
+    XorLinkedList& operator=(XorLinkedList&& other) noexcept;
+
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value)      { emplace_front(std::move(value)); }
+    void push_back(const T& value)  { emplace_back(value); }
+    void push_back(T&& value)       { emplace_back(std::move(value)); }
+
+    template <typename... Args> T& emplace_front(Args&&... args);
+    template <typename... Args> T& emplace_back(Args&&... args);
+
+    T    pop_front() { if (empty()) throw std::underflow_error("pop_front on empty list"); return take_front(); }
+    T    pop_back()  { if (empty()) throw std::underflow_error("pop_back on empty list");  return take_back(); }
+
+    std::optional<T> try_pop_front() { return empty() ? std::nullopt : std::optional<T>(take_front()); }
+    std::optional<T> try_pop_back()  { return empty() ? std::nullopt : std::optional<T>(take_back()); }
+
+    // Peeks; the list must not be empty.
+    T&       front()       { return head->data; }
+    const T& front() const { return head->data; }
+    T&       back()        { return tail->data; }
+    const T& back()  const { return tail->data; }
+
+    // Relink every node of other after our tail in O(1); other ends empty.
+    void splice_back(XorLinkedList& other);
+    // Swap the ends; no node is touched.
+    void reverse() noexcept { std::swap(head, tail); }
+    void clear() noexcept;
+
+    iterator               begin()         { return iterator(nullptr, head); }
+    iterator               end()           { return iterator(tail, nullptr); }
+    const_iterator         begin()   const { return const_iterator(nullptr, head); }
+    const_iterator         end()     const { return const_iterator(tail, nullptr); }
+    const_iterator         cbegin()  const { return begin(); }
+    const_iterator         cend()    const { return end(); }
+    reverse_iterator       rbegin()        { return reverse_iterator(end()); }
+    reverse_iterator       rend()          { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin()  const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()    const { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const { return rbegin(); }
+    const_reverse_iterator crend()   const { return rend(); }
+
+    std::size_t size() const  { return size_; }
+    bool        empty() const { return size_ == 0; }
+    void        print_forward()  const;
+    void        print_backward() const;
+
+private:
+    node_type*  head;
+    node_type*  tail;
+    std::size_t size_;
+    Allocator   alloc;
+
+    // The neighbour of cur that is not from.
+    static node_type* step(const node_type* from, const node_type* cur) {
+        return reinterpret_cast<node_type*>(cur->link ^ reinterpret_cast<std::uintptr_t>(from));
+    }
+    static std::uintptr_t bits(const node_type* n) { return reinterpret_cast<std::uintptr_t>(n); }
+
+    template <typename... Args> node_type* make_node(Args&&... args);
+    T    take_front();
+    T    take_back();
+
+    XorLinkedList(const XorLinkedList&)            = delete;
+    XorLinkedList& operator=(const XorLinkedList&) = delete;
+};
+
+/*
+ basic_iterator – carries the node it is on and the one it came from, which
+  is what an XOR link needs to step onwards. end() is (tail, null), so
+  stepping back from end() lands on tail.
+ */
+template <typename T, typename Allocator>
+template <bool Const>
+class XorLinkedList<T, Allocator>::basic_iterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::conditional<Const, const T*, T*>::type;
+    using reference         = typename std::conditional<Const, const T&, T&>::type;
+
+    basic_iterator() : prev(nullptr), node(nullptr) {}
+    template <bool C = Const, typename = typename std::enable_if<C>::type>
+    basic_iterator(const basic_iterator<false>& it) : prev(it.prev), node(it.node) {}
+
+    reference operator*()  const { return node->data; }
+    pointer   operator->() const { return std::addressof(node->data); }
+
+    basic_iterator& operator++() {
+        node_type* n = step(prev, node);
+        prev = node;
+        node = n;
+        return *this;
+    }
+    basic_iterator& operator--() {
+        node_type* p = step(node, prev);
+        node = prev;
+        prev = p;
+        return *this;
+    }
+    basic_iterator operator++(int) { basic_iterator t = *this; ++*this; return t; }
+    basic_iterator operator--(int) { basic_iterator t = *this; --*this; return t; }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.node == b.node && a.prev == b.prev; }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b) { return !(a == b); }
+
+private:
+    friend class XorLinkedList;
+    friend class basic_iterator<!Const>;
+
+    node_type* prev;
+    node_type* node;
+
+    basic_iterator(node_type* p, node_type* n) : prev(p), node(n) {}
+};
+
+template <typename T, typename Allocator>
+XorLinkedList<T, Allocator>& XorLinkedList<T, Allocator>::operator=(XorLinkedList&& other) noexcept {
+    if (this != &other) {
+        clear();
+        alloc = std::move(other.alloc);
+        head  = other.head;
+        tail  = other.tail;
+        size_ = other.size_;
+        other.head = other.tail = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+XorNode<T>* XorLinkedList<T, Allocator>::make_node(Args&&... args) {
+    node_type* n = new (alloc.allocate()) node_type();
+    try {
+        ::new (static_cast<void*>(std::addressof(n->data))) T(std::forward<Args>(args)...);
+    } catch (...) {
+        alloc.deallocate(n);
+        throw;
+    }
+    return n;
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+T& XorLinkedList<T, Allocator>::emplace_front(Args&&... args) {
+    node_type* n = make_node(std::forward<Args>(args)...);
+    n->link = bits(head);
+    if (head) head->link ^= bits(n);   // head's prev was null, now n
+    else      tail = n;
+    head = n;
+    ++size_;
+    return n->data;
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+T& XorLinkedList<T, Allocator>::emplace_back(Args&&... args) {
+    node_type* n = make_node(std::forward<Args>(args)...);
+    n->link = bits(tail);
+    if (tail) tail->link ^= bits(n);
+    else      head = n;
+    tail = n;
+    ++size_;
+    return n->data;
+}
+
+template <typename T, typename Allocator>
+T XorLinkedList<T, Allocator>::take_front() {
+    node_type* old = head;
+    head = step(nullptr, old);
+    if (head) head->link ^= bits(old);
+    else      tail = nullptr;
+    --size_;
+    T val = std::move(old->data);
+    old->data.~T();
+    alloc.deallocate(old);
+    return val;
+}
+
+template <typename T, typename Allocator>
+T XorLinkedList<T, Allocator>::take_back() {
+    node_type* old = tail;
+    tail = step(nullptr, old);
+    if (tail) tail->link ^= bits(old);
+    else      head = nullptr;
+    --size_;
+    T val = std::move(old->data);
+    old->data.~T();
+    alloc.deallocate(old);
+    return val;
+}
+
+// splice_back – falls back to moving elements when the allocators can't
+// share nodes, as DoublyLinkedList::splice does.
+template <typename T, typename Allocator>
+void XorLinkedList<T, Allocator>::splice_back(XorLinkedList& other) {
+    if (this == &other || other.empty()) return;
+    if (!alloc.absorb(other.alloc)) {
+        while (!other.empty()) emplace_back(other.take_front());
+        return;
+    }
+    if (tail) {
+        tail->link ^= bits(other.head);
+        other.head->link ^= bits(tail);
+    } else {
+        head = other.head;
+    }
+    tail   = other.tail;
+    size_ += other.size_;
+    other.head = other.tail = nullptr;
+    other.size_ = 0;
+}
+
+/*
+ clear – one walk that destroys each element and rewrites its link word as
+  a plain `next`, then the whole chain goes back to the allocator at once.
+ */
+template <typename T, typename Allocator>
+void XorLinkedList<T, Allocator>::clear() noexcept {
+    node_type* prev = nullptr;
+    for (node_type* cur = head; cur;) {
+        node_type* nxt = step(prev, cur);
+        if (!std::is_trivially_destructible<T>::value) cur->data.~T();
+        cur->next = nxt;
+        prev      = cur;
+        cur       = nxt;
+    }
+    alloc.deallocate_chain(head, tail);
+    head = tail = nullptr;
+    size_ = 0;
+}
+
+template <typename T, typename Allocator>
+void XorLinkedList<T, Allocator>::print_forward() const {
+    dll_io::print_framed(dll_io::Direction::forward, [this](auto emit) {
+        for (const T& v : *this) emit(v);
+    });
+}
+
+template <typename T, typename Allocator>
+void XorLinkedList<T, Allocator>::print_backward() const {
+    dll_io::print_framed(dll_io::Direction::backward, [this](auto emit) {
+        for (auto r = rbegin(); r != rend(); ++r) emit(*r);
+    });
+}
+
+/*
+ UnrolledChunk – one link of an UnrolledList. Live elements occupy
+  data[first, last); only the head and tail chunks are ever partly filled.
+ */
+template <typename T, std::size_t Capacity>
+struct UnrolledChunk {
+    union { T data[Capacity]; };
+    UnrolledChunk* prev;
+    UnrolledChunk* next;
+    std::uint32_t  first;
+    std::uint32_t  last;
+
+    UnrolledChunk() : prev(nullptr), next(nullptr), first(0), last(0) {}
+    ~UnrolledChunk() {}
+
+    std::size_t count() const { return last - first; }
+};
+
+// Roughly 512 bytes of payload per chunk, and never fewer than 4 slots.
+template <typename T>
+constexpr std::size_t unrolled_default_capacity() {
+    return 512 / sizeof(T) < 4 ? 4 : 512 / sizeof(T);
+}
+
+/*
+ UnrolledList – same push/pop-at-both-ends API as DoublyLinkedList, but each
+  link carries Capacity elements, so traversal walks contiguous arrays and
+  the prev/next overhead is paid once per chunk instead of once per element.
+ */
+template <typename T,
+          std::size_t Capacity = unrolled_default_capacity<T>(),
+          typename Allocator   = PoolAllocator<UnrolledChunk<T, Capacity>>>
+class UnrolledList {
+    static_assert(Capacity > 0, "UnrolledList needs at least one slot per chunk");
+
+public:
+    using value_type = T;
+    using chunk_type = UnrolledChunk<T, Capacity>;
+    static constexpr std::size_t chunk_capacity = Capacity;
+
+    UnrolledList() : head(nullptr), tail(nullptr), size_(0) {}
+    explicit UnrolledList(const Allocator& a)
+        : head(nullptr), tail(nullptr), size_(0), alloc(a) {}
+    ~UnrolledList() { clear(); }
+
+    UnrolledList(UnrolledList&& other) noexcept
+        : head(other.head), tail(other.tail), size_(other.size_),
+          alloc(std::move(other.alloc)) {
+        other.head = other.tail = nullptr;
+        other.size_ = 0;
+    }
+    UnrolledList& operator=(UnrolledList&& other) noexcept;
+
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value)      { emplace_front(std::move(value)); }
+    void push_back(const T& value)  { emplace_back(value); }
+    void push_back(T&& value)       { emplace_back(std::move(value)); }
+
+    template <typename... Args> T& emplace_front(Args&&... args);
+    template <typename... Args> T& emplace_back(Args&&... args);
+
+    T    pop_front() { if (empty()) throw std::underflow_error("pop_front on empty list"); return take_front(); }
+    T    pop_back()  { if (empty()) throw std::underflow_error("pop_back on empty list");  return take_back(); }
+
+    std::optional<T> try_pop_front() { return empty() ? std::nullopt : std::optional<T>(take_front()); }
+    std::optional<T> try_pop_back()  { return empty() ? std::nullopt : std::optional<T>(take_back()); }
+
+    // Peeks; the list must not be empty.
+    T&       front()       { return head->data[head->first]; }
+    const T& front() const { return head->data[head->first]; }
+    T&       back()        { return tail->data[tail->last - 1]; }
+    const T& back()  const { return tail->data[tail->last - 1]; }
+
+    void clear() noexcept;
+
+    // Visit every element in order, one contiguous run per chunk.
+    template <typename F> void for_each(F f) const;
+
+    /*
+     Whole-list scans. Each chunk is one contiguous run, so for int32
+     payloads they go through the dll_simd kernels; other T use plain loops.
+     */
+    using sum_type = typename std::conditional<
+        std::is_integral<T>::value,
+        typename std::conditional<std::is_signed<T>::value, std::int64_t, std::uint64_t>::type, T>::type;
+    static constexpr std::size_t npos = ~std::size_t(0);
+
+    std::size_t      find(const T& v) const;      // position of the first v, or npos
+    std::size_t      count(const T& v) const;
+    sum_type         sum() const;
+    sum_type         sum_positive() const;        // sum of the elements > 0
+    std::optional<T> min() const;
+    std::optional<T> max() const;
+
+    // Parallel scans over whole chunks; same contract as DoublyLinkedList's,
+    // but cutting only walks the chunk chain (n / Capacity hops).
+    template <typename F> void parallel_for_each(F f, unsigned threads = 0) const;
+    template <typename U, typename Fold, typename Combine>
+    U parallel_reduce(U identity, Fold fold, Combine combine, unsigned threads = 0) const;
+    template <typename Pred> std::size_t parallel_count_if(Pred pred, unsigned threads = 0) const;
+
+    std::size_t size() const { return size_; }
+    bool        empty() const { return size_ == 0; }
+    void        print_forward()  const;
+    void        print_backward() const;
+
+private:
+    chunk_type* head;
+    chunk_type* tail;
+    std::size_t size_;
+    Allocator   alloc;
+
+    static constexpr bool simd_payload = std::is_same<T, std::int32_t>::value;
+
+    std::vector<const chunk_type*> cut_chunks(std::size_t parts) const;
+
+    chunk_type* make_chunk(std::uint32_t start);
+    void        unlink_chunk(chunk_type* c);
+    T           take_front();
+    T           take_back();
+
+    UnrolledList(const UnrolledList&)            = delete;
+    UnrolledList& operator=(const UnrolledList&) = delete;
+};
+
+template <typename T, std::size_t Capacity, typename Allocator>
+UnrolledList<T, Capacity, Allocator>&
+UnrolledList<T, Capacity, Allocator>::operator=(UnrolledList&& other) noexcept {
+    if (this != &other) {
+        clear();
+        alloc = std::move(other.alloc);
+        head  = other.head;
+        tail  = other.tail;
+        size_ = other.size_;
+        other.head = other.tail = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+void UnrolledList<T, Capacity, Allocator>::clear() noexcept {
+    if (!std::is_trivially_destructible<T>::value)
+        for (chunk_type* c = head; c; c = c->next)
+            for (std::uint32_t i = c->first; i < c->last; ++i)
+                c->data[i].~T();
+    alloc.deallocate_chain(head, tail);
+    head = tail = nullptr;
+    size_ = 0;
+}
+
+// make_chunk – empty chunk whose live range starts (and ends) at `start`.
+template <typename T, std::size_t Capacity, typename Allocator>
+UnrolledChunk<T, Capacity>*
+UnrolledList<T, Capacity, Allocator>::make_chunk(std::uint32_t start) {
+    chunk_type* c = new (alloc.allocate()) chunk_type();
+    c->first = c->last = start;
+    return c;
+}
+
+// unlink_chunk – drop an empty head or tail chunk and recycle it.
+template <typename T, std::size_t Capacity, typename Allocator>
+void UnrolledList<T, Capacity, Allocator>::unlink_chunk(chunk_type* c) {
+    if (c->prev) c->prev->next = c->next;
+    else         head = c->next;
+    if (c->next) c->next->prev = c->prev;
+    else         tail = c->prev;
+    alloc.deallocate(c);
+}
+
+/*
+ emplace_front – fill the head chunk downwards; when it is full at the front
+  start a new chunk whose live range grows down from the top.
+ */
+template <typename T, std::size_t Capacity, typename Allocator>
+template <typename... Args>
+T& UnrolledList<T, Capacity, Allocator>::emplace_front(Args&&... args) {
+    chunk_type* c = head;
+    bool fresh = false;
+    if (!c || c->first == 0) {
+        c     = make_chunk(static_cast<std::uint32_t>(Capacity));
+        fresh = true;
+    }
+    try {
+        ::new (static_cast<void*>(&c->data[c->first - 1])) T(std::forward<Args>(args)...);
+    } catch (...) {
+        if (fresh) alloc.deallocate(c);
+        throw;
+    }
+    if (fresh) {
+        c->next = head;
+        if (head) head->prev = c;
+        head = c;
+        if (!tail) tail = c;
+    }
+    --c->first;
+    ++size_;
+    return c->data[c->first];
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+template <typename... Args>
+T& UnrolledList<T, Capacity, Allocator>::emplace_back(Args&&... args) {
+    chunk_type* c = tail;
+    bool fresh = false;
+    if (!c || c->last == Capacity) {
+        c     = make_chunk(0);
+        fresh = true;
+    }
+    try {
+        ::new (static_cast<void*>(&c->data[c->last])) T(std::forward<Args>(args)...);
+    } catch (...) {
+        if (fresh) alloc.deallocate(c);
+        throw;
+    }
+    if (fresh) {
+        c->prev = tail;
+        if (tail) tail->next = c;
+        tail = c;
+        if (!head) head = c;
+    }
+    ++c->last;
+    ++size_;
+    return c->data[c->last - 1];
+}
+
+
+template <typename T, std::size_t Capacity, typename Allocator>
+T UnrolledList<T, Capacity, Allocator>::take_front() {
+    chunk_type* c = head;
+    T val(std::move(c->data[c->first]));
+    c->data[c->first].~T();
+    ++c->first;
+    if (c->first == c->last) unlink_chunk(c);
+    --size_;
+    return val;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+T UnrolledList<T, Capacity, Allocator>::take_back() {
+    chunk_type* c = tail;
+    T val(std::move(c->data[c->last - 1]));
+    c->data[c->last - 1].~T();
+    --c->last;
+    if (c->first == c->last) unlink_chunk(c);
+    --size_;
+    return val;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+template <typename F>
+void UnrolledList<T, Capacity, Allocator>::for_each(F f) const {
+    for (const chunk_type* c = head; c; c = c->next) {
+        const T* p   = c->data + c->first;
+        const T* end = c->data + c->last;
+        for (; p != end; ++p) f(*p);
+    }
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+std::size_t UnrolledList<T, Capacity, Allocator>::find(const T& v) const {
+    std::size_t pos = 0;
+    for (const chunk_type* c = head; c; c = c->next) {
+        const T* first = c->data + c->first;
+        const T* last  = c->data + c->last;
+        const T* hit;
+        if constexpr (simd_payload) hit = dll_simd::active().find(first, last, v);
+        else                        hit = std::find(first, last, v);
+        if (hit != last) return pos + std::size_t(hit - first);
+        pos += c->count();
+    }
+    return npos;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+std::size_t UnrolledList<T, Capacity, Allocator>::count(const T& v) const {
+    std::size_t n = 0;
+    for (const chunk_type* c = head; c; c = c->next) {
+        if constexpr (simd_payload) n += dll_simd::active().count(c->data + c->first, c->data + c->last, v);
+        else                        n += std::size_t(std::count(c->data + c->first, c->data + c->last, v));
+    }
+    return n;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+typename UnrolledList<T, Capacity, Allocator>::sum_type UnrolledList<T, Capacity, Allocator>::sum() const {
+    sum_type s = sum_type();
+    for (const chunk_type* c = head; c; c = c->next) {
+        if constexpr (simd_payload) {
+            s += dll_simd::active().sum(c->data + c->first, c->data + c->last);
+        } else {
+            for (std::uint32_t k = c->first; k != c->last; ++k) s += c->data[k];
+        }
+    }
+    return s;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+typename UnrolledList<T, Capacity, Allocator>::sum_type
+UnrolledList<T, Capacity, Allocator>::sum_positive() const {
+    sum_type s = sum_type();
+    for (const chunk_type* c = head; c; c = c->next) {
+        if constexpr (simd_payload) {
+            s += dll_simd::active().sum_positive(c->data + c->first, c->data + c->last);
+        } else {
+            for (std::uint32_t k = c->first; k != c->last; ++k)
+                if (T() < c->data[k]) s += c->data[k];
+        }
+    }
+    return s;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+std::optional<T> UnrolledList<T, Capacity, Allocator>::min() const {
+    if (empty()) return std::nullopt;
+    T m = front();
+    for (const chunk_type* c = head; c; c = c->next) {
+        if constexpr (simd_payload) m = std::min(m, dll_simd::active().min(c->data + c->first, c->data + c->last));
+        else                        m = std::min(m, *std::min_element(c->data + c->first, c->data + c->last));
+    }
+    return m;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+std::optional<T> UnrolledList<T, Capacity, Allocator>::max() const {
+    if (empty()) return std::nullopt;
+    T m = front();
+    for (const chunk_type* c = head; c; c = c->next) {
+        if constexpr (simd_payload) m = std::max(m, dll_simd::active().max(c->data + c->first, c->data + c->last));
+        else                        m = std::max(m, *std::max_element(c->data + c->first, c->data + c->last));
+    }
+    return m;
+}
+
+// cut_chunks – parts + 1 chunk boundaries (the last is null), cut once each
+// part holds its share of the elements.
+template <typename T, std::size_t Capacity, typename Allocator>
+std::vector<const typename UnrolledList<T, Capacity, Allocator>::chunk_type*>
+UnrolledList<T, Capacity, Allocator>::cut_chunks(std::size_t parts) const {
+    std::vector<const chunk_type*> cuts;
+    cuts.reserve(parts + 1);
+    cuts.push_back(head);
+    std::size_t seen = 0;
+    for (const chunk_type* c = head; c && cuts.size() < parts; c = c->next) {
+        seen += c->last - c->first;
+        if (seen >= size_ * cuts.size() / parts && c->next) cuts.push_back(c->next);
+    }
+    cuts.push_back(nullptr);
+    return cuts;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+template <typename F>
+void UnrolledList<T, Capacity, Allocator>::parallel_for_each(F f, unsigned threads) const {
+    std::vector<const chunk_type*> cuts = cut_chunks(dll_parallel::part_count(size_, threads));
+    dll_parallel::run(cuts.size() - 1, [&](std::size_t i) {
+        for (const chunk_type* c = cuts[i]; c != cuts[i + 1]; c = c->next)
+            for (std::uint32_t k = c->first; k != c->last; ++k) f(c->data[k]);
+    });
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+template <typename U, typename Fold, typename Combine>
+U UnrolledList<T, Capacity, Allocator>::parallel_reduce(U identity, Fold fold, Combine combine,
+                                                        unsigned threads) const {
+    std::vector<const chunk_type*> cuts = cut_chunks(dll_parallel::part_count(size_, threads));
+    std::vector<U>                 partials(cuts.size() - 1, identity);
+    dll_parallel::run(partials.size(), [&](std::size_t i) {
+        U acc = identity;
+        for (const chunk_type* c = cuts[i]; c != cuts[i + 1]; c = c->next)
+            for (std::uint32_t k = c->first; k != c->last; ++k) acc = fold(std::move(acc), c->data[k]);
+        partials[i] = std::move(acc);
+    });
+    return dll_parallel::combine_all(partials, combine);
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+template <typename Pred>
+std::size_t UnrolledList<T, Capacity, Allocator>::parallel_count_if(Pred pred, unsigned threads) const {
+    std::vector<const chunk_type*> cuts = cut_chunks(dll_parallel::part_count(size_, threads));
+    std::vector<std::size_t>       counts(cuts.size() - 1);
+    dll_parallel::run(counts.size(), [&](std::size_t i) {
+        std::size_t n = 0;
+        for (const chunk_type* c = cuts[i]; c != cuts[i + 1]; c = c->next)
+            for (std::uint32_t k = c->first; k != c->last; ++k) n += pred(c->data[k]) ? 1 : 0;
+        counts[i] = n;
+    });
+    std::size_t total = 0;
+    for (std::size_t n : counts) total += n;
+    return total;
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+void UnrolledList<T, Capacity, Allocator>::print_forward() const {
+    dll_io::print_framed(dll_io::Direction::forward, [this](auto emit) { for_each(emit); });
+}
+
+template <typename T, std::size_t Capacity, typename Allocator>
+void UnrolledList<T, Capacity, Allocator>::print_backward() const {
+    dll_io::print_framed(dll_io::Direction::backward, [this](auto emit) {
+        for (const chunk_type* c = tail; c; c = c->prev)
+            for (std::uint32_t i = c->last; i > c->first; --i) emit(c->data[i - 1]);
+    });
+}
+
+/*
+ PersistentList – a deque whose snapshot() is O(1). A snapshot is an
+  immutable version of the list that any thread may keep iterating while
+  the list itself goes on changing.
+
+  Elements live in chunks of Capacity slots and the chunks in a spine, an
+  array indexed by absolute position / Capacity. Both are reference
+  counted: the list and every snapshot hold their spine, every spine holds
+  its chunks. A version is just its spine and a [first, last) range of
+  positions, so taking a snapshot bumps one count. Writes never touch a
+  slot that some version can still read:
+    - a push into a never-used slot (the usual push_back / pop_front churn)
+      writes in place, even into a shared chunk;
+    - a push over an element an older version still sees copies that one
+      chunk first, and the spine too if it is shared (path copying);
+    - pops only narrow the range; the element is moved out and destroyed
+      only when no snapshot can see it, copied out otherwise.
+  A chunk is freed when the last spine holding it goes, a spine when the
+  last version holding it goes, which may happen on a reader's thread. The
+  list keeps one chunk it freed as a spare and recentres its spine in
+  place when no snapshot holds it, so steady queue churn never allocates.
+
+  One thread writes (or writers hold a common lock, snapshot() included);
+  snapshots may be copied, read and dropped from any thread. Iterators and
+  references into the list itself are invalidated by any write, those into
+  a snapshot only by dropping it.
+ */
+template <typename T, std::size_t Capacity = unrolled_default_capacity<T>()>
+class PersistentList {
+    static_assert(Capacity > 0 && Capacity <= 0xffffffffu, "PersistentList chunk capacity out of range");
+    static_assert(std::is_copy_constructible<T>::value,
+                  "PersistentList copies elements a snapshot shares");
+
+    struct Chunk {
+        std::atomic<std::size_t> refs;     // spines holding this chunk
+        std::uint32_t            lo, hi;   // constructed: data[lo, hi)
+        union { T data[Capacity]; };
+
+        explicit Chunk(std::uint32_t at) : refs(1), lo(at), hi(at) {}
+        ~Chunk() {}
+    };
+    struct Spine {
+        std::atomic<std::size_t> refs;     // versions holding this spine
+        std::size_t              base;     // chunk number of slots()[0]
+        std::size_t              cap;
+        std::size_t              lo, hi;   // slots()[lo, hi) each hold a chunk
+
+        Spine(std::size_t b, std::size_t c) : refs(1), base(b), cap(c), lo(0), hi(0) {}
+        Chunk** slots() { return reinterpret_cast<Chunk**>(this + 1); }
+    };
+
+    // Positions start mid-range so either end can grow without wrapping.
+    static constexpr std::size_t origin = (~std::size_t(0) / 2) / Capacity * Capacity;
+
+    struct Version {
+        Spine*      spine = nullptr;
+        std::size_t first = origin;
+        std::size_t last  = origin;
+
+        const T& at(std::size_t pos) const {
+            return spine->slots()[pos / Capacity - spine->base]->data[pos % Capacity];
+        }
+        template <typename F> void for_each(F& f) const;
+    };
+
+public:
+    using value_type = T;
+    static constexpr std::size_t chunk_capacity = Capacity;
+
+    class const_iterator;
+    class Snapshot;
+
+    PersistentList() = default;
+    ~PersistentList() {
+        release(v.spine);
+        delete spare;
+    }
+
+    PersistentList(PersistentList&& other) noexcept : v(other.v), spare(other.spare) {
+        other.v     = Version();
+        other.spare = nullptr;
+    }
+    PersistentList& operator=(PersistentList&& other) noexcept {
+        std::swap(v, other.v);
+        std::swap(spare, other.spare);
+        return *this;
+    }
+
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value)      { emplace_front(std::move(value)); }
+    void push_back(const T& value)  { emplace_back(value); }
+    void push_back(T&& value)       { emplace_back(std::move(value)); }
+
+    // Elements are read-only once in: a snapshot may be sharing them.
+    template <typename... Args> const T& emplace_front(Args&&... args);
+    template <typename... Args> const T& emplace_back(Args&&... args);
+
+    T    pop_front() { if (empty()) throw std::underflow_error("pop_front on empty list"); return take_front(); }
+    T    pop_back()  { if (empty()) throw std::underflow_error("pop_back on empty list");  return take_back(); }
+
+    std::optional<T> try_pop_front() { return empty() ? std::nullopt : std::optional<T>(take_front()); }
+    std::optional<T> try_pop_back()  { return empty() ? std::nullopt : std::optional<T>(take_back()); }
+
+    // Peeks; the list must not be empty. operator[] is O(1).
+    const T& front() const                   { return v.at(v.first); }
+    const T& back() const                    { return v.at(v.last - 1); }
+    const T& operator[](std::size_t k) const { return v.at(v.first + k); }
+
+    void clear() noexcept {
+        release(v.spine);
+        v = Version();
+    }
+
+    // The current contents as an immutable version; O(1).
+    Snapshot snapshot() const { return Snapshot(v); }
+
+    const_iterator begin() const { return const_iterator(v.spine, v.first, v.last); }
+    const_iterator end() const   { return const_iterator(v.spine, v.last, v.last); }
+    // Visit every element in order, one contiguous run per chunk.
+    template <typename F> void for_each(F f) const { v.for_each(f); }
+
+    std::size_t size() const { return v.last - v.first; }
+    bool        empty() const { return v.first == v.last; }
+    void        print_forward() const;
+    void        print_backward() const;
+
+private:
+    Version v;
+    Chunk*  spare = nullptr;   // a freed chunk kept for the next one needed
+
+    static void retain(Spine* s) { if (s) s->refs.fetch_add(1, std::memory_order_relaxed); }
+    static void release(Spine* s);
+    static void release(Chunk* c);
+    // The writer's side of release(Chunk*): the last reference goes to spare.
+    void        drop(Chunk* c);
+    Chunk*      new_chunk(std::uint32_t at);
+    Chunk*      copy_chunk(const Chunk* c, std::uint32_t lo, std::uint32_t hi);
+
+    bool   spine_exclusive() const { return v.spine->refs.load(std::memory_order_acquire) == 1; }
+    bool   exclusive(const Chunk* c) const {
+        return spine_exclusive() && c->refs.load(std::memory_order_acquire) == 1;
+    }
+    void   reshape(std::size_t want);
+    void   restart();
+    Chunk* back_slot();
+    Chunk* front_slot();
+    T      take_front();
+    T      take_back();
+
+    PersistentList(const PersistentList&)            = delete;
+    PersistentList& operator=(const PersistentList&) = delete;
+};
+
+// const_iterator – forward iterator over one version's positions.
+template <typename T, std::size_t Capacity>
+class PersistentList<T, Capacity>::const_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const T*;
+    using reference         = const T&;
+
+    const_iterator() : spine(nullptr), pos(0), last(0), cur(nullptr) {}
+
+    reference operator*() const  { return *cur; }
+    pointer   operator->() const { return cur; }
+
+    const_iterator& operator++() {
+        if (++pos % Capacity == 0 && pos != last) cur = spine->slots()[pos / Capacity - spine->base]->data;
+        else                                      ++cur;
+        return *this;
+    }
+    const_iterator operator++(int) { const_iterator t = *this; ++*this; return t; }
+
+    friend bool operator==(const const_iterator& a, const const_iterator& b) { return a.pos == b.pos; }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a.pos != b.pos; }
+
+private:
+    friend class PersistentList;
+
+    Spine*      spine;
+    std::size_t pos;
+    std::size_t last;
+    const T*    cur;
+
+    const_iterator(Spine* s, std::size_t p, std::size_t l)
+        : spine(s), pos(p), last(l),
+          cur(p != l ? s->slots()[p / Capacity - s->base]->data + p % Capacity : nullptr) {}
+};
+
+// Snapshot – a read-only version of a PersistentList; copies are O(1).
+template <typename T, std::size_t Capacity>
+class PersistentList<T, Capacity>::Snapshot {
+public:
+    using value_type = T;
+
+    Snapshot() = default;
+    Snapshot(const Snapshot& other) : v(other.v) { retain(v.spine); }
+    Snapshot(Snapshot&& other) noexcept : v(other.v) { other.v = Version(); }
+    Snapshot& operator=(Snapshot other) noexcept {
+        std::swap(v, other.v);
+        return *this;
+    }
+    ~Snapshot() { release(v.spine); }
+
+    const T& front() const                   { return v.at(v.first); }
+    const T& back() const                    { return v.at(v.last - 1); }
+    const T& operator[](std::size_t k) const { return v.at(v.first + k); }
+
+    const_iterator begin() const { return const_iterator(v.spine, v.first, v.last); }
+    const_iterator end() const   { return const_iterator(v.spine, v.last, v.last); }
+    template <typename F> void for_each(F f) const { v.for_each(f); }
+
+    std::size_t size() const { return v.last - v.first; }
+    bool        empty() const { return v.first == v.last; }
+    void        print_forward() const {
+        dll_io::print_framed(dll_io::Direction::forward, [this](auto emit) { for_each(emit); });
+    }
+
+private:
+    friend class PersistentList;
+
+    Version v;
+
+    explicit Snapshot(const Version& version) : v(version) { retain(v.spine); }
+};
+
+template <typename T, std::size_t Capacity>
+template <typename F>
+void PersistentList<T, Capacity>::Version::for_each(F& f) const {
+    for (std::size_t pos = first; pos != last;) {
+        const Chunk*  c   = spine->slots()[pos / Capacity - spine->base];
+        std::uint32_t off = static_cast<std::uint32_t>(pos % Capacity);
+        std::size_t   n   = std::min<std::size_t>(Capacity - off, last - pos);
+        for (std::size_t i = 0; i < n; ++i) f(c->data[off + i]);
+        pos += n;
+    }
+}
+
+template <typename T, std::size_t Capacity>
+void PersistentList<T, Capacity>::release(Chunk* c) {
+    if (c->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    if (!std::is_trivially_destructible<T>::value)
+        for (std::uint32_t i = c->lo; i < c->hi; ++i) c->data[i].~T();
+    delete c;
+}
+
+template <typename T, std::size_t Capacity>
+void PersistentList<T, Capacity>::release(Spine* s) {
+    if (!s || s->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    for (std::size_t i = s->lo; i < s->hi; ++i) release(s->slots()[i]);
+    s->~Spine();
+    ::operator delete(static_cast<void*>(s));
+}
+
+template <typename T, std::size_t Capacity>
+void PersistentList<T, Capacity>::drop(Chunk* c) {
+    if (c->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    if (!std::is_trivially_destructible<T>::value)
+        for (std::uint32_t i = c->lo; i < c->hi; ++i) c->data[i].~T();
+    if (spare) delete c;
+    else       spare = c;
+}
+
+template <typename T, std::size_t Capacity>
+typename PersistentList<T, Capacity>::Chunk* PersistentList<T, Capacity>::new_chunk(std::uint32_t at) {
+    if (!spare) return new Chunk(at);
+    Chunk* c = spare;
+    spare    = nullptr;
+    c->refs.store(1, std::memory_order_relaxed);
+    c->lo = c->hi = at;
+    return c;
+}
+
+template <typename T, std::size_t Capacity>
+typename PersistentList<T, Capacity>::Chunk*
+PersistentList<T, Capacity>::copy_chunk(const Chunk* c, std::uint32_t lo, std::uint32_t hi) {
+    Chunk* copy = new_chunk(lo);
+    try {
+        for (; copy->hi < hi; ++copy->hi)
+            ::new (static_cast<void*>(std::addressof(copy->data[copy->hi]))) T(c->data[copy->hi]);
+    } catch (...) {
+        drop(copy);
+        throw;
+    }
+    return copy;
+}
+
+/*
+ reshape – leave a spine holding just the live chunks, with room for chunk
+  number want and as much again to spare, centred so either end can grow.
+  A spine only we hold that is big enough is recentred in place; otherwise
+  we move to a new one and the old stays with whichever snapshots hold it.
+ */
+template <typename T, std::size_t Capacity>
+void PersistentList<T, Capacity>::reshape(std::size_t want) {
+    std::size_t live_lo = v.first / Capacity;
+    std::size_t live_hi = empty() ? live_lo : (v.last - 1) / Capacity + 1;
+    std::size_t lo      = empty() ? want : std::min(live_lo, want);
+    std::size_t hi      = empty() ? want + 1 : std::max(live_hi, want + 1);
+    if (Spine* s = v.spine; s && 2 * (hi - lo) <= s->cap && spine_exclusive()) {
+        for (std::size_t i = s->lo; i < s->hi; ++i)
+            if (s->base + i < live_lo || s->base + i >= live_hi) drop(s->slots()[i]);
+        std::size_t base = lo - (s->cap - (hi - lo)) / 2;
+        if (!empty())
+            std::memmove(s->slots() + (live_lo - base), s->slots() + (live_lo - s->base),
+                         (live_hi - live_lo) * sizeof(Chunk*));
+        s->base = base;
+        s->lo   = (empty() ? want : live_lo) - base;
+        s->hi   = empty() ? s->lo : live_hi - base;
+        return;
+    }
+    std::size_t cap = std::max<std::size_t>(8, 2 * (hi - lo));
+    void*       raw = ::operator new(sizeof(Spine) + cap * sizeof(Chunk*));
+    Spine*      s       = new (raw) Spine(lo - (cap - (hi - lo)) / 2, cap);
+    if (empty()) {
+        s->lo = s->hi = want - s->base;
+    } else {
+        s->lo = s->hi = live_lo - s->base;
+        for (std::size_t c = live_lo; c < live_hi; ++c) {
+            Chunk* chunk = v.spine->slots()[c - v.spine->base];
+            chunk->refs.fetch_add(1, std::memory_order_relaxed);
+            s->slots()[s->hi++] = chunk;
+        }
+    }
+    release(v.spine);
+    v.spine = s;
+}
+
+/*
+ back_slot – the chunk to construct position last in, with that slot free:
+  a fresh chunk when last starts one, otherwise the tail chunk after any
+  elements still lying past last are destroyed (if only we see them) or the
+  chunk has been copied without them (if a snapshot does).
+ */
+template <typename T, std::size_t Capacity>
+typename PersistentList<T, Capacity>::Chunk* PersistentList<T, Capacity>::back_slot() {
+    std::size_t   cn  = v.last / Capacity;
+    std::uint32_t off = static_cast<std::uint32_t>(v.last % Capacity);
+    if (!v.spine || cn < v.spine->base || cn - v.spine->base >= v.spine->cap) reshape(cn);
+    Spine*      s = v.spine;
+    std::size_t i = cn - s->base;
+
+    if (empty() || off == 0) {
+        bool taken = i >= s->lo && i < s->hi;   // by a chunk only older versions see
+        if (taken && spine_exclusive()) {
+            while (s->hi > i) drop(s->slots()[--s->hi]);
+            taken = false;
+        }
+        if (taken || (s->lo != s->hi && i != s->hi)) {
+            reshape(cn);
+            s = v.spine;
+            i = cn - s->base;
+        }
+        Chunk* c = new_chunk(off);
+        if (s->lo == s->hi) s->lo = i;
+        s->slots()[i] = c;
+        s->hi         = i + 1;
+        return c;
+    }
+
+    Chunk* c = s->slots()[i];
+    if (off < c->hi) {
+        if (!spine_exclusive()) {
+            reshape(cn);
+            s = v.spine;
+            i = cn - s->base;
+        }
+        if (c->refs.load(std::memory_order_acquire) == 1) {
+            while (c->hi > off) c->data[--c->hi].~T();
+        } else {
+            std::size_t   start = cn * Capacity;
+            std::uint32_t from  = v.first > start ? static_cast<std::uint32_t>(v.first - start) : 0;
+            Chunk*        copy  = copy_chunk(c, from, off);
+            s->slots()[i]       = copy;
+            drop(c);
+            c = copy;
+        }
+    }
+    return c;
+}
+
+// front_slot – back_slot's mirror image, for position first - 1.
+template <typename T, std::size_t Capacity>
+typename PersistentList<T, Capacity>::Chunk* PersistentList<T, Capacity>::front_slot() {
+    std::size_t   pos = v.first - 1;
+    std::size_t   cn  = pos / Capacity;
+    std::uint32_t off = static_cast<std::uint32_t>(pos % Capacity);
+    if (!v.spine || cn < v.spine->base || cn - v.spine->base >= v.spine->cap) reshape(cn);
+    Spine*      s = v.spine;
+    std::size_t i = cn - s->base;
+
+    if (empty() || off == Capacity - 1) {
+        bool taken = i >= s->lo && i < s->hi;
+        if (taken && spine_exclusive()) {
+            while (s->lo <= i) drop(s->slots()[s->lo++]);
+            taken = false;
+        }
+        if (taken || (s->lo != s->hi && i + 1 != s->lo)) {
+            reshape(cn);
+            s = v.spine;
+            i = cn - s->base;
+        }
+        Chunk* c = new_chunk(off + 1);
+        if (s->lo == s->hi) s->hi = i + 1;
+        s->slots()[i] = c;
+        s->lo         = i;
+        return c;
+    }
+
+    Chunk* c = s->slots()[i];
+    if (off >= c->lo) {
+        if (!spine_exclusive()) {
+            reshape(cn);
+            s = v.spine;
+            i = cn - s->base;
+        }
+        if (c->refs.load(std::memory_order_acquire) == 1) {
+            while (c->lo <= off) c->data[c->lo++].~T();
+        } else {
+            std::size_t   end  = (cn + 1) * Capacity;
+            std::uint32_t to   = v.last < end ? static_cast<std::uint32_t>(v.last - cn * Capacity)
+                                              : static_cast<std::uint32_t>(Capacity);
+            Chunk*        copy = copy_chunk(c, off + 1, to);
+            s->slots()[i]      = copy;
+            drop(c);
+            c = copy;
+        }
+    }
+    return c;
+}
+
+template <typename T, std::size_t Capacity>
+template <typename... Args>
+const T& PersistentList<T, Capacity>::emplace_back(Args&&... args) {
+    Chunk*        c   = back_slot();
+    std::uint32_t off = static_cast<std::uint32_t>(v.last % Capacity);
+    ::new (static_cast<void*>(std::addressof(c->data[off]))) T(std::forward<Args>(args)...);
+    c->hi = off + 1;
+    ++v.last;
+    return c->data[off];
+}
+
+template <typename T, std::size_t Capacity>
+template <typename... Args>
+const T& PersistentList<T, Capacity>::emplace_front(Args&&... args) {
+    Chunk*        c   = front_slot();
+    std::uint32_t off = static_cast<std::uint32_t>((v.first - 1) % Capacity);
+    ::new (static_cast<void*>(std::addressof(c->data[off]))) T(std::forward<Args>(args)...);
+    c->lo = off;
+    --v.first;
+    return c->data[off];
+}
+
+// restart – once the list is empty and only we hold the spine, drop every
+// chunk and start again from the middle of the spine.
+template <typename T, std::size_t Capacity>
+void PersistentList<T, Capacity>::restart() {
+    Spine* s = v.spine;
+    if (!spine_exclusive()) return;
+    while (s->hi > s->lo) drop(s->slots()[--s->hi]);
+    s->lo = s->hi = s->cap / 2;
+    v.first = v.last = (s->base + s->cap / 2) * Capacity + Capacity / 2;
+}
+
+/*
+ take_front / take_back – move the element out if no snapshot can see it
+  (destroying it, and any dead neighbours, on the spot), copy it otherwise.
+  A chunk nobody else holds is released as soon as the list leaves it.
+ */
+template <typename T, std::size_t Capacity>
+T PersistentList<T, Capacity>::take_front() {
+    Spine*        s    = v.spine;
+    std::size_t   i    = v.first / Capacity - s->base;
+    std::uint32_t off  = static_cast<std::uint32_t>(v.first % Capacity);
+    Chunk*        c    = s->slots()[i];
+    bool          mine = exclusive(c);
+    T             out  = mine ? T(std::move(c->data[off])) : T(c->data[off]);
+    ++v.first;
+    if (mine)
+        while (c->lo <= off) c->data[c->lo++].~T();
+    if (off == Capacity - 1 && !empty() && spine_exclusive())
+        while (s->lo <= i) drop(s->slots()[s->lo++]);
+    else if (empty()) restart();
+    return out;
+}
+
+template <typename T, std::size_t Capacity>
+T PersistentList<T, Capacity>::take_back() {
+    Spine*        s    = v.spine;
+    std::size_t   i    = (v.last - 1) / Capacity - s->base;
+    std::uint32_t off  = static_cast<std::uint32_t>((v.last - 1) % Capacity);
+    Chunk*        c    = s->slots()[i];
+    bool          mine = exclusive(c);
+    T             out  = mine ? T(std::move(c->data[off])) : T(c->data[off]);
+    --v.last;
+    if (mine)
+        while (c->hi > off) c->data[--c->hi].~T();
+    if (off == 0 && !empty() && spine_exclusive())
+        while (s->hi > i) drop(s->slots()[--s->hi]);
+    else if (empty()) restart();
+    return out;
+}
+
+template <typename T, std::size_t Capacity>
+void PersistentList<T, Capacity>::print_forward() const {
+    dll_io::print_framed(dll_io::Direction::forward, [this](auto emit) { for_each(emit); });
+}
+
+template <typename T, std::size_t Capacity>
+void PersistentList<T, Capacity>::print_backward() const {
+    dll_io::print_framed(dll_io::Direction::backward, [this](auto emit) {
+        for (std::size_t pos = v.last; pos != v.first; --pos) emit(v.at(pos - 1));
+    });
+}
+
+/*
+ IndexSlot – one entry of an IndexList's storage array. Links are 32-bit
+  slot numbers instead of pointers; a free slot is marked by prev == freed
+  and threads the free list through `next`.
+ */
+template <typename T>
+struct IndexSlot {
+    union { T data; };
+    std::uint32_t prev;
+    std::uint32_t next;
+
+    IndexSlot() {}
+    ~IndexSlot() {}
+};
+
+/*
+ IndexList – doubly linked list whose nodes live in one growable array and
+  link by index. Push operations return a handle (the slot number) that stays
+  valid until that element is removed, so callers can erase or reorder an
+  element in O(1) without keeping a pointer into the list.
+ */
+template <typename T>
+class IndexList {
+public:
+    using value_type = T;
+    using handle     = std::uint32_t;
+    static constexpr handle npos = 0xFFFFFFFFu;
+
+    IndexList() : slots(nullptr), cap(0), used(0), head(npos), tail(npos),
+                  free_head(npos), size_(0) {}
+    ~IndexList();
+
+    IndexList(IndexList&& other) noexcept
+        : slots(other.slots), cap(other.cap), used(other.used), head(other.head),
+          tail(other.tail), free_head(other.free_head), size_(other.size_),
+          backing(std::move(other.backing)) {
+        other.slots = nullptr;
+        other.cap = other.used = 0;
+        other.head = other.tail = other.free_head = npos;
+        other.size_ = 0;
+    }
+    IndexList& operator=(IndexList&& other) noexcept;
+
+    handle push_front(const T& value) { return emplace_front(value); }
+    handle push_front(T&& value)      { return emplace_front(std::move(value)); }
+    handle push_back(const T& value)  { return emplace_back(value); }
+    handle push_back(T&& value)       { return emplace_back(std::move(value)); }
+
+    template <typename... Args> handle emplace_front(Args&&... args);
+    template <typename... Args> handle emplace_back(Args&&... args);
+
+    T    pop_front() { if (empty()) throw std::underflow_error("pop_front on empty list"); return take_front(); }
+    T    pop_back()  { if (empty()) throw std::underflow_error("pop_back on empty list");  return take_back(); }
+
+    std::optional<T> try_pop_front() { return empty() ? std::nullopt : std::optional<T>(take_front()); }
+    std::optional<T> try_pop_back()  { return empty() ? std::nullopt : std::optional<T>(take_back()); }
+
+    // Peeks; the list must not be empty.
+    T&       front()       { return slots[head].data; }
+    const T& front() const { return slots[head].data; }
+    T&       back()        { return slots[tail].data; }
+    const T& back()  const { return slots[tail].data; }
+
+    // O(1) removal / reordering by handle.
+    void erase(handle h);
+    void move_to_front(handle h);
+    void move_to_back(handle h);
+    // Stable merge sort of the list order; relinks slots, so every handle
+    // keeps naming the same element. Compares read straight from the slot
+    // array, never chasing a heap pointer.
+    template <typename Compare> void sort(Compare comp);
+    void sort() { sort(std::less<T>()); }
+
+    bool     contains(handle h) const { return h < used && slots[h].prev != freed; }
+    T&       operator[](handle h)       { return slots[h].data; }
+    const T& operator[](handle h) const { return slots[h].data; }
+
+    // Walk by handle: front_handle() then next(h) until npos.
+    handle front_handle() const { return head; }
+    handle back_handle()  const { return tail; }
+    handle next(handle h) const { return slots[h].next; }
+    handle prev(handle h) const { return slots[h].prev; }
+
+    void reserve(std::size_t n);
+    void clear() noexcept;
+
+    // Parallel scans straight over the slot array: no cutting walk at all,
+    // but elements are visited in slot order, not list order, so reduce's
+    // combine must be commutative as well as associative.
+    template <typename F> void parallel_for_each(F f, unsigned threads = 0) const;
+    template <typename U, typename Fold, typename Combine>
+    U parallel_reduce(U identity, Fold fold, Combine combine, unsigned threads = 0) const;
+    template <typename Pred> std::size_t parallel_count_if(Pred pred, unsigned threads = 0) const;
+
+    std::size_t size() const     { return size_; }
+    std::size_t capacity() const { return cap; }
+    bool        empty() const    { return size_ == 0; }
+    void        print_forward()  const;
+    void        print_backward() const;
+
+    // Binary checkpoint of the raw slot array, so handles survive a restart.
+    void             save_snapshot(std::ostream& os) const;
+    void             load_snapshot(std::istream& is);
+#if DLL_HAVE_POSIX_WRITE
+    // Zero-copy: the list uses the mapped slots in place until it first grows.
+    static IndexList map_snapshot(const char* path);
+#endif
+
+private:
+    static constexpr std::uint32_t freed = 0xFFFFFFFEu; // prev value of a free slot
+    static constexpr std::size_t   max_slots = freed;    // npos and freed are reserved
+
+    IndexSlot<T>* slots;
+    std::uint32_t cap;
+    std::uint32_t used;       // slots [0, used) have been handed out at least once
+    handle        head;
+    handle        tail;
+    handle        free_head;
+    std::size_t   size_;
+    std::shared_ptr<void> backing;   // set while slots live in a mapped snapshot
+
+    void release_storage() noexcept;
+    static void          check_snapshot(const dll_snapshot::Header& h);
+    static void          check_slots(const IndexSlot<T>* s, const dll_snapshot::Header& h);
+    static IndexSlot<T>* allocate_slots(std::size_t n);
+    void relocate(IndexSlot<T>* fresh, std::size_t n);
+    template <typename... Args> handle make_slot(Args&&... args);
+    void unlink(handle h);
+    void link_front(handle h);
+    void link_back(handle h);
+    void release_slot(handle h);
+    T    take_front();
+    T    take_back();
+
+    IndexList(const IndexList&)            = delete;
+    IndexList& operator=(const IndexList&) = delete;
+};
+
+template <typename T>
+IndexList<T>::~IndexList() {
+    clear();
+    release_storage();
+}
+
+// release_storage – free the slot array, or drop our hold on the mapping.
+template <typename T>
+void IndexList<T>::release_storage() noexcept {
+    if (backing) backing.reset();
+    else         ::operator delete(static_cast<void*>(slots));
+    slots = nullptr;
+}
+
+template <typename T>
+IndexList<T>& IndexList<T>::operator=(IndexList&& other) noexcept {
+    if (this != &other) {
+        clear();
+        release_storage();
+        slots = other.slots;  cap  = other.cap;   used      = other.used;
+        head  = other.head;   tail = other.tail;  free_head = other.free_head;
+        size_ = other.size_;
+        backing = std::move(other.backing);
+        other.slots = nullptr;
+        other.cap = other.used = 0;
+        other.head = other.tail = other.free_head = npos;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+/*
+ reserve – grow the array, relocating live elements. Links are indices, so
+  they are copied verbatim; trivially copyable payloads move with memcpy.
+ */
+template <typename T>
+void IndexList<T>::reserve(std::size_t n) {
+    if (n <= cap) return;
+    IndexSlot<T>* fresh = allocate_slots(n);
+    try {
+        relocate(fresh, n);
+    } catch (...) {
+        ::operator delete(static_cast<void*>(fresh));
+        throw;
+    }
+}
+
+template <typename T>
+IndexSlot<T>* IndexList<T>::allocate_slots(std::size_t n) {
+    if (n > max_slots) throw std::length_error("IndexList exceeds 32-bit handle space");
+    return static_cast<IndexSlot<T>*>(::operator new(n * sizeof(IndexSlot<T>)));
+}
+
+/*
+ relocate – move the live elements of [0, used) into fresh (n slots) and
+  adopt it. Every element is constructed in fresh before any old one is
+  destroyed, so a throwing copy leaves the list as it was; fresh itself is
+  the caller's to free in that case.
+ */
+template <typename T>
+void IndexList<T>::relocate(IndexSlot<T>* fresh, std::size_t n) {
+    if (std::is_trivially_copyable<T>::value) {
+        if (used) std::memcpy(static_cast<void*>(fresh), slots, used * sizeof(IndexSlot<T>));
+    } else {
+        std::uint32_t i = 0;
+        try {
+            for (; i < used; ++i) {
+                new (&fresh[i]) IndexSlot<T>();
+                fresh[i].prev = slots[i].prev;
+                fresh[i].next = slots[i].next;
+                if (slots[i].prev != freed)
+                    ::new (static_cast<void*>(std::addressof(fresh[i].data)))
+                        T(std::move_if_noexcept(slots[i].data));
+            }
+        } catch (...) {
+            while (i-- > 0)
+                if (slots[i].prev != freed) fresh[i].data.~T();
+            throw;
+        }
+        for (i = 0; i < used; ++i)
+            if (slots[i].prev != freed) slots[i].data.~T();
+    }
+    release_storage();
+    slots = fresh;
+    cap   = static_cast<std::uint32_t>(n);
+}
+
+template <typename T>
+void IndexList<T>::clear() noexcept {
+    if (!std::is_trivially_destructible<T>::value)
+        for (handle h = head; h != npos; h = slots[h].next)
+            slots[h].data.~T();
+    used = 0;
+    head = tail = free_head = npos;
+    size_ = 0;
+}
+
+// make_slot – reuse a freed slot if there is one, else take the next new one.
+template <typename T>
+template <typename... Args>
+typename IndexList<T>::handle IndexList<T>::make_slot(Args&&... args) {
+    handle h;
+    if (free_head != npos) {
+        h = free_head;
+        ::new (static_cast<void*>(std::addressof(slots[h].data))) T(std::forward<Args>(args)...);
+        free_head = slots[h].next;
+    } else if (used == cap) {
+        // args may name an element of this list: build the new element in
+        // the grown array before the old one is relocated and freed.
+        std::size_t   n     = cap ? std::size_t(cap) * 2 : 16;
+        IndexSlot<T>* fresh = allocate_slots(n);
+        h = used;
+        new (&fresh[h]) IndexSlot<T>();
+        try {
+            ::new (static_cast<void*>(std::addressof(fresh[h].data))) T(std::forward<Args>(args)...);
+        } catch (...) {
+            ::operator delete(static_cast<void*>(fresh));
+            throw;
+        }
+        try {
+            relocate(fresh, n);
+        } catch (...) {
+            fresh[h].data.~T();
+            ::operator delete(static_cast<void*>(fresh));
+            throw;
+        }
+        ++used;
+    } else {
+        h = used;
+        new (&slots[h]) IndexSlot<T>();
+        ::new (static_cast<void*>(std::addressof(slots[h].data))) T(std::forward<Args>(args)...);
+        ++used;
+    }
+    slots[h].prev = slots[h].next = npos;
+    ++size_;
+    return h;
+}
+
+template <typename T>
+void IndexList<T>::release_slot(handle h) {
+    slots[h].data.~T();
+    slots[h].prev = freed;
+    slots[h].next = free_head;
+    free_head     = h;
+    --size_;
+}
+
+template <typename T>
+void IndexList<T>::link_front(handle h) {
+    slots[h].prev = npos;
+    slots[h].next = head;
+    if (head != npos) slots[head].prev = h;
+    head = h;
+    if (tail == npos) tail = h;
+}
+
+template <typename T>
+void IndexList<T>::link_back(handle h) {
+    slots[h].next = npos;
+    slots[h].prev = tail;
+    if (tail != npos) slots[tail].next = h;
+    tail = h;
+    if (head == npos) head = h;
+}
+
+template <typename T>
+void IndexList<T>::unlink(handle h) {
+    handle p = slots[h].prev;
+    handle n = slots[h].next;
+    if (p != npos) slots[p].next = n;
+    else           head = n;
+    if (n != npos) slots[n].prev = p;
+    else           tail = p;
+}
+
+template <typename T>
+template <typename... Args>
+typename IndexList<T>::handle IndexList<T>::emplace_front(Args&&... args) {
+    handle h = make_slot(std::forward<Args>(args)...);
+    link_front(h);
+    return h;
+}
+
+template <typename T>
+template <typename... Args>
+typename IndexList<T>::handle IndexList<T>::emplace_back(Args&&... args) {
+    handle h = make_slot(std::forward<Args>(args)...);
+    link_back(h);
+    return h;
+}
+
+template <typename T>
+T IndexList<T>::take_front() {
+    handle h = head;
+    T val(std::move(slots[h].data));
+    unlink(h);
+    release_slot(h);
+    return val;
+}
+
+template <typename T>
+T IndexList<T>::take_back() {
+    handle h = tail;
+    T val(std::move(slots[h].data));
+    unlink(h);
+    release_slot(h);
+    return val;
+}
+
+template <typename T>
+void IndexList<T>::erase(handle h) {
+    if (!contains(h)) throw std::out_of_range("erase of a stale IndexList handle");
+    unlink(h);
+    release_slot(h);
+}
+
+template <typename T>
+void IndexList<T>::move_to_front(handle h) {
+    if (h == head) return;
+    unlink(h);
+    link_front(h);
+}
+
+template <typename T>
+void IndexList<T>::move_to_back(handle h) {
+    if (h == tail) return;
+    unlink(h);
+    link_back(h);
+}
+
+template <typename T>
+template <typename Compare>
+void IndexList<T>::sort(Compare comp) {
+    if (size_ < 2) return;
+    handle first  = head;
+    auto   relink = [&] {
+        handle prev = npos;
+        for (handle h = first; h != npos; h = slots[h].next) {
+            slots[h].prev = prev;
+            prev          = h;
+        }
+        head = first;
+        tail = prev;
+    };
+    try {
+        dll_sort::sort_chain(first, npos,
+                             [this](handle h) -> handle& { return slots[h].next; },
+                             [&](handle a, handle b) { return comp(slots[a].data, slots[b].data); });
+    } catch (...) {
+        relink();
+        throw;
+    }
+    relink();
+}
+
+template <typename T>
+template <typename F>
+void IndexList<T>::parallel_for_each(F f, unsigned threads) const {
+    std::size_t parts = dll_parallel::part_count(size_, threads);
+    dll_parallel::run(parts, [&](std::size_t i) {
+        for (std::size_t s = used * i / parts, e = used * (i + 1) / parts; s != e; ++s)
+            if (slots[s].prev != freed) f(static_cast<const T&>(slots[s].data));
+    });
+}
+
+template <typename T>
+template <typename U, typename Fold, typename Combine>
+U IndexList<T>::parallel_reduce(U identity, Fold fold, Combine combine, unsigned threads) const {
+    std::vector<U> partials(dll_parallel::part_count(size_, threads), identity);
+    std::size_t    parts = partials.size();
+    dll_parallel::run(parts, [&](std::size_t i) {
+        U acc = identity;
+        for (std::size_t s = used * i / parts, e = used * (i + 1) / parts; s != e; ++s)
+            if (slots[s].prev != freed) acc = fold(std::move(acc), static_cast<const T&>(slots[s].data));
+        partials[i] = std::move(acc);
+    });
+    return dll_parallel::combine_all(partials, combine);
+}
+
+template <typename T>
+template <typename Pred>
+std::size_t IndexList<T>::parallel_count_if(Pred pred, unsigned threads) const {
+    std::vector<std::size_t> counts(dll_parallel::part_count(size_, threads));
+    std::size_t              parts = counts.size();
+    dll_parallel::run(parts, [&](std::size_t i) {
+        std::size_t n = 0;
+        for (std::size_t s = used * i / parts, e = used * (i + 1) / parts; s != e; ++s)
+            if (slots[s].prev != freed && pred(static_cast<const T&>(slots[s].data))) ++n;
+        counts[i] = n;
+    });
+    std::size_t total = 0;
+    for (std::size_t n : counts) total += n;
+    return total;
+}
+
+/*
+ save_snapshot / load_snapshot / map_snapshot – the slot array is written
+  verbatim (free slots included) after a header padded to 64 bytes, so a
+  mapped file can serve as the slot array directly.
+ */
+template <typename T>
+void IndexList<T>::save_snapshot(std::ostream& os) const {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots need trivially copyable T");
+    dll_snapshot::Header h = dll_snapshot::make_header<T>(dll_snapshot::Layout::index_slots, size_);
+    h.slot_size = sizeof(IndexSlot<T>);
+    h.used      = used;
+    h.head      = head;
+    h.tail      = tail;
+    h.free_head = free_head;
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    os.write(reinterpret_cast<const char*>(slots),
+             static_cast<std::streamsize>(std::size_t(used) * sizeof(IndexSlot<T>)));
+    if (!os) throw std::runtime_error("failed to write list snapshot");
+}
+
+// check_snapshot – reject a header whose links or count do not fit its slots.
+template <typename T>
+void IndexList<T>::check_snapshot(const dll_snapshot::Header& h) {
+    dll_snapshot::check<T>(h, dll_snapshot::Layout::index_slots);
+    if (h.slot_size != sizeof(IndexSlot<T>)) throw std::runtime_error("list snapshot slot size mismatch");
+    if (h.payload_offset % alignof(IndexSlot<T>) != 0)
+        throw std::runtime_error("list snapshot payload offset out of range");
+    auto in_range = [&h](std::uint32_t i) { return i == npos || i < h.used; };
+    if (!in_range(h.head) || !in_range(h.tail) || !in_range(h.free_head) || h.count > h.used)
+        throw std::runtime_error("corrupt list snapshot");
+}
+
+/*
+ check_slots – walk both chains of a loaded slot array before trusting it:
+  the list must reach tail in exactly count hops with every prev link
+  pointing back, the free chain must end within the remaining slots, and no
+  slot may sit on neither. O(used).
+ */
+template <typename T>
+void IndexList<T>::check_slots(const IndexSlot<T>* s, const dll_snapshot::Header& h) {
+    const auto corrupt = [] { throw std::runtime_error("corrupt list snapshot"); };
+    std::uint64_t live = 0;
+    for (std::uint32_t i = 0; i < h.used; ++i) {
+        if (s[i].prev == freed) continue;
+        if (s[i].prev != npos && s[i].prev >= h.used) corrupt();
+        if (s[i].next != npos && s[i].next >= h.used) corrupt();
+        ++live;
+    }
+    if (live != h.count) corrupt();
+
+    handle prev = npos;
+    handle at   = h.head;
+    for (std::uint64_t k = 0; k < h.count; ++k) {
+        if (at >= h.used || s[at].prev != prev) corrupt();
+        prev = at;
+        at   = s[at].next;
+    }
+    if (at != npos || prev != h.tail) corrupt();
+
+    at = h.free_head;
+    for (std::uint64_t k = h.count; k < h.used; ++k) {
+        if (at >= h.used || s[at].prev != freed) corrupt();
+        at = s[at].next;
+    }
+    if (at != npos) corrupt();
+}
+
+template <typename T>
+void IndexList<T>::load_snapshot(std::istream& is) {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots need trivially copyable T");
+    dll_snapshot::Header h;
+    dll_snapshot::read_exact(is, &h, sizeof(h));
+    check_snapshot(h);
+    is.ignore(static_cast<std::streamsize>(h.payload_offset - sizeof(h)));
+
+    clear();
+    reserve(h.used);
+    dll_snapshot::read_exact(is, slots, std::size_t(h.used) * sizeof(IndexSlot<T>));
+    check_slots(slots, h);
+    used      = h.used;
+    head      = h.head;
+    tail      = h.tail;
+    free_head = h.free_head;
+    size_     = static_cast<std::size_t>(h.count);
+}
+
+#if DLL_HAVE_POSIX_WRITE
+template <typename T>
+IndexList<T> IndexList<T>::map_snapshot(const char* path) {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots need trivially copyable T");
+    auto file = std::make_shared<dll_snapshot::MappedFile>(path);
+    const dll_snapshot::Header& h = file->header();
+    check_snapshot(h);
+
+    auto* mapped = reinterpret_cast<IndexSlot<T>*>(file->payload(h.used, sizeof(IndexSlot<T>)));
+    check_slots(mapped, h);
+
+    IndexList list;
+    list.slots     = mapped;
+    list.cap       = h.used;
+    list.used      = h.used;
+    list.head      = h.head;
+    list.tail      = h.tail;
+    list.free_head = h.free_head;
+    list.size_     = static_cast<std::size_t>(h.count);
+    list.backing   = std::move(file);
+    return list;
+}
+#endif
+
+template <typename T>
+void IndexList<T>::print_forward() const {
+    dll_io::print_framed(dll_io::Direction::forward, [this](auto emit) {
+        for (handle h = head; h != npos; h = slots[h].next) emit(slots[h].data);
+    });
+}
+
+template <typename T>
+void IndexList<T>::print_backward() const {
+    dll_io::print_framed(dll_io::Direction::backward, [this](auto emit) {
+        for (handle h = tail; h != npos; h = slots[h].prev) emit(slots[h].data);
+    });
+}
+
+/*
+ StaticDoublyLinkedList – doubly linked list of at most N elements whose
+  storage (values, links and free list) is all embedded in the object: no
+  heap use, every operation constexpr and noexcept, so a list can be built
+  at compile time or used where `new` is banned.
+  Links are the smallest unsigned index type that fits N. Every slot holds
+  a live T (unused ones are default constructed), so T must be nothrow
+  default constructible and move assignable; pushing a copy is noexcept
+  when T's copy assignment is.
+  A push onto a full list follows Policy: `reject` leaves the list alone and
+  returns PushStatus::full; `overwrite_oldest` drops the element at the
+  opposite end (the oldest when pushing at the back) to make room.
+ */
+enum class OverflowPolicy { reject, overwrite_oldest };
+enum class PushStatus { ok, full, overwrote };
+
+template <typename T, std::size_t N, OverflowPolicy Policy = OverflowPolicy::reject>
+class StaticDoublyLinkedList {
+    static_assert(N > 0 && N < 0xFFFFFFFFu, "StaticDoublyLinkedList needs 1 to 2^32-2 slots");
+    static_assert(std::is_default_constructible<T>::value, "slots are default constructed");
+    static_assert(std::is_nothrow_default_constructible<T>::value && std::is_nothrow_move_assignable<T>::value,
+                  "operations are noexcept, so T's default construction and move assignment must be too");
+
+public:
+    using value_type = T;
+    using index_type = typename std::conditional<
+        (N < 0xFFu), std::uint8_t,
+        typename std::conditional<(N < 0xFFFFu), std::uint16_t, std::uint32_t>::type>::type;
+    static constexpr index_type npos = static_cast<index_type>(~index_type(0));
+
+    template <bool Const> class basic_iterator;
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    constexpr StaticDoublyLinkedList() noexcept {
+        for (std::size_t i = 0; i < N; ++i) next_[i] = i + 1 < N ? static_cast<index_type>(i + 1) : npos;
+    }
+
+    constexpr PushStatus push_front(const T& value) noexcept(nothrow_copy) { return push(value, true); }
+    constexpr PushStatus push_front(T&& value) noexcept                    { return push(std::move(value), true); }
+    constexpr PushStatus push_back(const T& value) noexcept(nothrow_copy)  { return push(value, false); }
+    constexpr PushStatus push_back(T&& value) noexcept                     { return push(std::move(value), false); }
+
+    // Insert before pos; a full list is never overwritten here: returns end().
+    constexpr iterator insert(const_iterator pos, T value) noexcept;
+    constexpr iterator erase(const_iterator pos) noexcept;
+
+    constexpr std::optional<T> try_pop_front() noexcept { return empty() ? std::nullopt : std::optional<T>(take(head_)); }
+    constexpr std::optional<T> try_pop_back() noexcept  { return empty() ? std::nullopt : std::optional<T>(take(tail_)); }
+
+    // Peeks; the list must not be empty.
+    constexpr T&       front() noexcept       { return values_[head_]; }
+    constexpr const T& front() const noexcept { return values_[head_]; }
+    constexpr T&       back() noexcept        { return values_[tail_]; }
+    constexpr const T& back() const noexcept  { return values_[tail_]; }
+
+    constexpr iterator       begin() noexcept       { return iterator(this, head_); }
+    constexpr iterator       end() noexcept         { return iterator(this, npos); }
+    constexpr const_iterator begin() const noexcept { return const_iterator(this, head_); }
+    constexpr const_iterator end() const noexcept   { return const_iterator(this, npos); }
+    constexpr const_iterator cbegin() const noexcept { return begin(); }
+    constexpr const_iterator cend() const noexcept   { return end(); }
+
+    constexpr void clear() noexcept;
+
+    constexpr std::size_t           size() const noexcept  { return size_; }
+    constexpr bool                  empty() const noexcept { return size_ == 0; }
+    constexpr bool                  full() const noexcept  { return size_ == N; }
+    static constexpr std::size_t    capacity() noexcept    { return N; }
+    void                            print_forward() const;
+    void                            print_backward() const;
+
+private:
+    static constexpr bool nothrow_copy = std::is_nothrow_copy_assignable<T>::value;
+
+    T           values_[N] {};
+    index_type  prev_[N] {};
+    index_type  next_[N] {};      // doubles as the free-list link
+    index_type  head_      = npos;
+    index_type  tail_      = npos;
+    index_type  free_      = 0;
+    std::size_t size_      = 0;
+
+    template <typename V>
+    constexpr PushStatus push(V&& value, bool at_front) noexcept(std::is_nothrow_assignable<T&, V&&>::value);
+    constexpr index_type claim() noexcept;
+    constexpr void       link_before(index_type i, index_type at) noexcept;
+    constexpr void       unlink(index_type i) noexcept;
+    constexpr T          take(index_type i) noexcept;
+};
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+template <bool Const>
+class StaticDoublyLinkedList<T, N, Policy>::basic_iterator {
+    using list_ptr = typename std::conditional<Const, const StaticDoublyLinkedList*, StaticDoublyLinkedList*>::type;
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::conditional<Const, const T*, T*>::type;
+    using reference         = typename std::conditional<Const, const T&, T&>::type;
+
+    constexpr basic_iterator() noexcept : list(nullptr), i(npos) {}
+    template <bool C = Const, typename = typename std::enable_if<C>::type>
+    constexpr basic_iterator(const basic_iterator<false>& it) noexcept : list(it.list), i(it.i) {}
+
+    constexpr reference operator*() const noexcept  { return list->values_[i]; }
+    constexpr pointer   operator->() const noexcept { return &list->values_[i]; }
+
+    constexpr basic_iterator& operator++() noexcept { i = list->next_[i]; return *this; }
+    constexpr basic_iterator& operator--() noexcept { i = i == npos ? list->tail_ : list->prev_[i]; return *this; }
+    constexpr basic_iterator  operator++(int) noexcept { basic_iterator t = *this; ++*this; return t; }
+    constexpr basic_iterator  operator--(int) noexcept { basic_iterator t = *this; --*this; return t; }
+
+    friend constexpr bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i == b.i; }
+    friend constexpr bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i != b.i; }
+
+private:
+    friend class StaticDoublyLinkedList;
+    friend class basic_iterator<!Const>;
+
+    list_ptr   list;
+    index_type i;
+
+    constexpr basic_iterator(list_ptr l, index_type idx) noexcept : list(l), i(idx) {}
+};
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+template <typename V>
+constexpr PushStatus StaticDoublyLinkedList<T, N, Policy>::push(V&& value, bool at_front)
+    noexcept(std::is_nothrow_assignable<T&, V&&>::value) {
+    PushStatus status = PushStatus::ok;
+    if (full()) {
+        if (Policy == OverflowPolicy::reject) return PushStatus::full;
+        take(at_front ? tail_ : head_);
+        status = PushStatus::overwrote;
+    }
+    values_[free_] = std::forward<V>(value);   // the slot is claimed only once this succeeds
+    index_type i   = claim();
+    link_before(i, at_front ? head_ : npos);
+    return status;
+}
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+constexpr typename StaticDoublyLinkedList<T, N, Policy>::iterator
+StaticDoublyLinkedList<T, N, Policy>::insert(const_iterator pos, T value) noexcept {
+    if (full()) return end();
+    index_type i = claim();
+    values_[i]   = std::move(value);
+    link_before(i, pos.i);
+    return iterator(this, i);
+}
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+constexpr typename StaticDoublyLinkedList<T, N, Policy>::iterator
+StaticDoublyLinkedList<T, N, Policy>::erase(const_iterator pos) noexcept {
+    index_type after = next_[pos.i];
+    take(pos.i);
+    return iterator(this, after);
+}
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+constexpr void StaticDoublyLinkedList<T, N, Policy>::clear() noexcept {
+    while (!empty()) take(head_);
+}
+
+// claim – pop a slot off the free list; the list must not be full.
+template <typename T, std::size_t N, OverflowPolicy Policy>
+constexpr typename StaticDoublyLinkedList<T, N, Policy>::index_type
+StaticDoublyLinkedList<T, N, Policy>::claim() noexcept {
+    index_type i = free_;
+    free_        = next_[i];
+    ++size_;
+    return i;
+}
+
+// link_before – put slot i in front of slot at (npos: at the back).
+template <typename T, std::size_t N, OverflowPolicy Policy>
+constexpr void StaticDoublyLinkedList<T, N, Policy>::link_before(index_type i, index_type at) noexcept {
+    index_type before = at == npos ? tail_ : prev_[at];
+    prev_[i] = before;
+    next_[i] = at;
+    if (before != npos) next_[before] = i;
+    else                head_ = i;
+    if (at != npos) prev_[at] = i;
+    else            tail_ = i;
+}
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+constexpr void StaticDoublyLinkedList<T, N, Policy>::unlink(index_type i) noexcept {
+    if (prev_[i] != npos) next_[prev_[i]] = next_[i];
+    else                  head_ = next_[i];
+    if (next_[i] != npos) prev_[next_[i]] = prev_[i];
+    else                  tail_ = prev_[i];
+}
+
+// take – unlink slot i, move its value out and put the slot on the free list.
+template <typename T, std::size_t N, OverflowPolicy Policy>
+constexpr T StaticDoublyLinkedList<T, N, Policy>::take(index_type i) noexcept {
+    unlink(i);
+    T value    = std::move(values_[i]);
+    values_[i] = T();
+    next_[i]   = free_;
+    free_      = i;
+    --size_;
+    return value;
+}
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+void StaticDoublyLinkedList<T, N, Policy>::print_forward() const {
+    dll_io::print_framed(dll_io::Direction::forward, [this](auto emit) {
+        for (const T& v : *this) emit(v);
+    });
+}
+
+template <typename T, std::size_t N, OverflowPolicy Policy>
+void StaticDoublyLinkedList<T, N, Policy>::print_backward() const {
+    dll_io::print_framed(dll_io::Direction::backward, [this](auto emit) {
+        for (index_type i = tail_; i != npos; i = prev_[i]) emit(values_[i]);
+    });
+}
+
+/*
+ LruCache – fixed-capacity least-recently-used map. Entries live in an
+  IndexList (most recent at the front) and an open-addressing hash table of
+  32-bit handles points into it, so get/put/erase/eviction are all O(1)
+  and nothing is allocated after construction.
+  The table uses linear probing at a load factor of at most 1/2 and
+  backward-shift deletion, so there are no tombstones to clean up. Each
+  bucket keeps 32 bits of the key's mixed hash next to the handle, which
+  rejects almost every non-matching probe without touching the entry.
+ */
+template <typename K, typename V,
+          typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class LruCache {
+public:
+    using key_type    = K;
+    using mapped_type = V;
+
+    explicit LruCache(std::size_t capacity, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual());
+
+    LruCache(LruCache&&) noexcept            = default;
+    LruCache& operator=(LruCache&&) noexcept = default;
+
+    // Hit: the entry becomes the most recent. Miss: nullptr.
+    V*       get(const K& key);
+    // Look up without touching the recency order.
+    V*       peek(const K& key);
+    const V* peek(const K& key) const;
+    bool     contains(const K& key) const { return find(key, tag_of(key)) != no_bucket; }
+
+    // Insert or overwrite; either way the entry becomes the most recent.
+    // A full cache first evicts its least recent entry. True if key was new.
+    bool put(K key, V value);
+    bool erase(const K& key);
+    // Drop the least recent entry and return it; nullopt when empty.
+    std::optional<std::pair<K, V>> evict();
+    void clear() noexcept;
+
+    // Visit (key, value) from most to least recently used.
+    template <typename F> void for_each(F f) const;
+
+    std::size_t size() const     { return entries.size(); }
+    std::size_t capacity() const { return cap; }
+    bool        empty() const    { return entries.empty(); }
+
+private:
+    struct Entry {
+        K             key;
+        V             value;
+        std::uint32_t tag;
+    };
+    struct Bucket {
+        std::uint32_t handle;   // `empty_bucket` when unused
+        std::uint32_t tag;      // top 32 bits of the mixed hash
+    };
+    using handle = typename IndexList<Entry>::handle;
+
+    static constexpr std::uint32_t empty_bucket = IndexList<Entry>::npos;
+    static constexpr std::size_t   no_bucket    = ~std::size_t(0);
+
+    IndexList<Entry>    entries;
+    std::vector<Bucket> buckets;
+    std::size_t         cap;
+    unsigned            home_shift;   // tag >> home_shift is the home bucket
+    Hash                hasher;
+    KeyEqual            equal;
+
+    std::uint32_t tag_of(const K& key) const {
+        std::uint64_t m = std::uint64_t(hasher(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+    std::size_t home(std::uint32_t tag) const { return tag >> home_shift; }
+    std::size_t mask() const                  { return buckets.size() - 1; }
+
+    std::size_t find(const K& key, std::uint32_t tag) const;
+    std::size_t bucket_of(handle h) const;
+    void        unindex(std::size_t i);
+    void        index(handle h, std::uint32_t tag);
+};
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+LruCache<K, V, Hash, KeyEqual>::LruCache(std::size_t capacity, const Hash& hash, const KeyEqual& eq)
+    : cap(capacity), home_shift(32), hasher(hash), equal(eq) {
+    if (capacity == 0) throw std::invalid_argument("LruCache capacity must be positive");
+    if (capacity > (std::size_t(1) << 30)) throw std::length_error("LruCache capacity too large");
+    std::size_t n = 2;                 // 2^(32 - home_shift) buckets
+    --home_shift;
+    while (n < 2 * capacity) { n <<= 1; --home_shift; }
+    buckets.assign(n, Bucket{empty_bucket, 0});
+    entries.reserve(capacity);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+V* LruCache<K, V, Hash, KeyEqual>::get(const K& key) {
+    std::size_t i = find(key, tag_of(key));
+    if (i == no_bucket) return nullptr;
+    entries.move_to_front(buckets[i].handle);
+    return &entries[buckets[i].handle].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+V* LruCache<K, V, Hash, KeyEqual>::peek(const K& key) {
+    std::size_t i = find(key, tag_of(key));
+    return i == no_bucket ? nullptr : &entries[buckets[i].handle].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const V* LruCache<K, V, Hash, KeyEqual>::peek(const K& key) const {
+    std::size_t i = find(key, tag_of(key));
+    return i == no_bucket ? nullptr : &entries[buckets[i].handle].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool LruCache<K, V, Hash, KeyEqual>::put(K key, V value) {
+    std::uint32_t t = tag_of(key);
+    std::size_t   i = find(key, t);
+    if (i != no_bucket) {
+        handle h = buckets[i].handle;
+        entries[h].value = std::move(value);
+        entries.move_to_front(h);
+        return false;
+    }
+    if (entries.size() == cap) evict();
+    index(entries.push_front(Entry{std::move(key), std::move(value), t}), t);
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool LruCache<K, V, Hash, KeyEqual>::erase(const K& key) {
+    std::size_t i = find(key, tag_of(key));
+    if (i == no_bucket) return false;
+    handle h = buckets[i].handle;
+    unindex(i);
+    entries.erase(h);
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<std::pair<K, V>> LruCache<K, V, Hash, KeyEqual>::evict() {
+    if (entries.empty()) return std::nullopt;
+    unindex(bucket_of(entries.back_handle()));
+    Entry e = entries.pop_back();
+    return std::optional<std::pair<K, V>>(std::in_place, std::move(e.key), std::move(e.value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LruCache<K, V, Hash, KeyEqual>::clear() noexcept {
+    entries.clear();
+    std::fill(buckets.begin(), buckets.end(), Bucket{empty_bucket, 0});
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename F>
+void LruCache<K, V, Hash, KeyEqual>::for_each(F f) const {
+    for (handle h = entries.front_handle(); h != IndexList<Entry>::npos; h = entries.next(h))
+        f(static_cast<const K&>(entries[h].key), static_cast<const V&>(entries[h].value));
+}
+
+// find – bucket holding key, or no_bucket. The table is never full, so the
+// probe always reaches an empty bucket on a miss.
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::size_t LruCache<K, V, Hash, KeyEqual>::find(const K& key, std::uint32_t tag) const {
+    for (std::size_t i = home(tag);; i = (i + 1) & mask()) {
+        const Bucket& b = buckets[i];
+        if (b.handle == empty_bucket) return no_bucket;
+        if (b.tag == tag && equal(entries[b.handle].key, key)) return i;
+    }
+}
+
+// bucket_of – bucket pointing at entry h; compares handles only.
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::size_t LruCache<K, V, Hash, KeyEqual>::bucket_of(handle h) const {
+    std::size_t i = home(entries[h].tag);
+    while (buckets[i].handle != h) i = (i + 1) & mask();
+    return i;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LruCache<K, V, Hash, KeyEqual>::index(handle h, std::uint32_t tag) {
+    std::size_t i = home(tag);
+    while (buckets[i].handle != empty_bucket) i = (i + 1) & mask();
+    buckets[i] = Bucket{h, tag};
+}
+
+/*
+ unindex – empty bucket i, then pull later members of its probe run back
+  into the hole wherever that does not move them before their home bucket.
+ */
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LruCache<K, V, Hash, KeyEqual>::unindex(std::size_t i) {
+    std::size_t hole = i;
+    for (std::size_t j = (i + 1) & mask(); buckets[j].handle != empty_bucket; j = (j + 1) & mask()) {
+        std::size_t h = home(buckets[j].tag);
+        if (((j - h) & mask()) >= ((j - hole) & mask())) {
+            buckets[hole] = buckets[j];
+            hole          = j;
+        }
+    }
+    buckets[hole].handle = empty_bucket;
+}
+
+/*
+ ShardedLruCache – LruCache split into independently locked shards for
+  concurrent use. A key always maps to the same shard, so threads working on
+  different shards never contend; recency and eviction are per shard, which
+  approximates a global LRU. get() returns a copy because the entry may be
+  evicted as soon as the shard lock is released.
+ */
+template <typename K, typename V,
+          typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class ShardedLruCache {
+public:
+    // capacity is split as evenly as possible across the shards.
+    explicit ShardedLruCache(std::size_t capacity, std::size_t shard_count = 16,
+                             const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual());
+
+    std::optional<V> get(const K& key);
+    bool             contains(const K& key) const;
+    bool             put(K key, V value);
+    bool             erase(const K& key);
+    void             clear();
+
+    std::size_t size() const;
+    std::size_t capacity() const    { return cap; }
+    std::size_t shard_count() const { return shards.size(); }
+
+private:
+    // One cache line per shard header so neighbouring locks do not false-share.
+    struct alignas(64) Shard {
+        mutable std::mutex              lock;
+        LruCache<K, V, Hash, KeyEqual> cache;
+        Shard(std::size_t c, const Hash& h, const KeyEqual& e) : cache(c, h, e) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::size_t                         cap;
+    Hash                                hasher;
+
+    // A different multiplier from LruCache's, so shard choice and bucket
+    // choice use unrelated bits of the hash.
+    Shard& shard_for(const K& key) const {
+        std::uint64_t m = std::uint64_t(hasher(key)) * 0xD6E8FEB86659FD93ull;
+        return *shards[(m >> 32) % shards.size()];
+    }
+};
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+ShardedLruCache<K, V, Hash, KeyEqual>::ShardedLruCache(std::size_t capacity, std::size_t shard_count,
+                                                      const Hash& hash, const KeyEqual& eq)
+    : cap(capacity), hasher(hash) {
+    if (capacity == 0 || shard_count == 0)
+        throw std::invalid_argument("ShardedLruCache capacity and shard count must be positive");
+    if (shard_count > capacity) shard_count = capacity;
+    shards.reserve(shard_count);
+    for (std::size_t s = 0; s < shard_count; ++s)
+        shards.push_back(std::make_unique<Shard>(capacity / shard_count + (s < capacity % shard_count), hash, eq));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<V> ShardedLruCache<K, V, Hash, KeyEqual>::get(const K& key) {
+    Shard&                      s = shard_for(key);
+    std::lock_guard<std::mutex> guard(s.lock);
+    V*                          v = s.cache.get(key);
+    return v ? std::optional<V>(*v) : std::nullopt;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLruCache<K, V, Hash, KeyEqual>::contains(const K& key) const {
+    Shard&                      s = shard_for(key);
+    std::lock_guard<std::mutex> guard(s.lock);
+    return s.cache.contains(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLruCache<K, V, Hash, KeyEqual>::put(K key, V value) {
+    Shard&                      s = shard_for(key);
+    std::lock_guard<std::mutex> guard(s.lock);
+    return s.cache.put(std::move(key), std::move(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLruCache<K, V, Hash, KeyEqual>::erase(const K& key) {
+    Shard&                      s = shard_for(key);
+    std::lock_guard<std::mutex> guard(s.lock);
+    return s.cache.erase(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void ShardedLruCache<K, V, Hash, KeyEqual>::clear() {
+    for (auto& s : shards) {
+        std::lock_guard<std::mutex> guard(s->lock);
+        s->cache.clear();
+    }
+}
+
+// size – sum over shards, each read under its own lock (not a global snapshot).
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::size_t ShardedLruCache<K, V, Hash, KeyEqual>::size() const {
+    std::size_t n = 0;
+    for (auto& s : shards) {
+        std::lock_guard<std::mutex> guard(s->lock);
+        n += s->cache.size();
+    }
+    return n;
+}
+
+/*
+ IntrusiveHook – prev/next links embedded in a user object by deriving from
+  it. Tag lets one object carry several hooks and so sit in several lists at
+  once (derive from IntrusiveHook<TagA> and IntrusiveHook<TagB>).
+  Copying an object never copies its links, and destroying a linked object
+  unlinks it first.
+ */
+template <typename Tag = void>
+class IntrusiveHook {
+public:
+    IntrusiveHook() noexcept : prev(nullptr), next(nullptr) {}
+    IntrusiveHook(const IntrusiveHook&) noexcept : prev(nullptr), next(nullptr) {}
+    IntrusiveHook& operator=(const IntrusiveHook&) noexcept { return *this; }
+    ~IntrusiveHook() { unlink(); }
+
+    bool is_linked() const noexcept { return next != nullptr; }
+
+    // O(1) removal from whichever list holds this object; no-op if unlinked.
+    void unlink() noexcept {
+        if (!next) return;
+        prev->next = next;
+        next->prev = prev;
+        prev = next = nullptr;
+    }
+
+private:
+    template <typename, typename> friend class IntrusiveList;
+
+    IntrusiveHook* prev;
+    IntrusiveHook* next;
+
+    // Put this hook just before pos, leaving any list it was in.
+    void link_before(IntrusiveHook* pos) noexcept {
+        if (pos == this) return;   // inserting an object before itself
+        unlink();
+        prev       = pos->prev;
+        next       = pos;
+        prev->next = this;
+        pos->prev  = this;
+    }
+};
+
+/*
+ IntrusiveList – doubly linked list of objects that derive from
+  IntrusiveHook<Tag>. The list only links the objects it is given: it never
+  allocates, copies or destroys them, so the caller keeps them alive while
+  they are linked. Pushing an object that is already in a list moves it.
+  The links form a ring through a sentinel hook inside the list, which is
+  what lets an object unlink itself without knowing its list; the price is
+  that size() counts (O(n)) rather than keeping a counter.
+ */
+template <typename T, typename Tag = void>
+class IntrusiveList {
+public:
+    using hook_type       = IntrusiveHook<Tag>;
+    using value_type      = T;
+    using reference       = T&;
+    using const_reference = const T&;
+    using size_type       = std::size_t;
+
+    template <bool Const> class basic_iterator;
+    using iterator               = basic_iterator<false>;
+    using const_iterator         = basic_iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    IntrusiveList() noexcept { root.prev = root.next = &root; }
+    ~IntrusiveList() { clear(); }
+
+    IntrusiveList(IntrusiveList&& other) noexcept : IntrusiveList() { splice_back(other); }
+    IntrusiveList& operator=(IntrusiveList&& other) noexcept {
+        if (this != &other) {
+            clear();
+            splice_back(other);
+        }
+        return *this;
+    }
+
+    void push_front(T& obj) noexcept { hook(obj)->link_before(root.next); }
+    void push_back(T& obj)  noexcept { hook(obj)->link_before(&root); }
+
+    // Unlink and return the end object; throws on an empty list.
+    T&   pop_front() { if (empty()) throw std::underflow_error("pop_front on empty list"); return take(root.next); }
+    T&   pop_back()  { if (empty()) throw std::underflow_error("pop_back on empty list");  return take(root.prev); }
+
+    // As above, but nullptr when empty.
+    T*   try_pop_front() noexcept { return empty() ? nullptr : &take(root.next); }
+    T*   try_pop_back()  noexcept { return empty() ? nullptr : &take(root.prev); }
+
+    // Peeks; the list must not be empty.
+    T&       front()       { return object(root.next); }
+    const T& front() const { return object(root.next); }
+    T&       back()        { return object(root.prev); }
+    const T& back()  const { return object(root.prev); }
+
+    iterator begin() noexcept { return iterator(root.next); }
+    iterator end()   noexcept { return iterator(&root); }
+    const_iterator begin()  const noexcept { return const_iterator(root.next); }
+    const_iterator end()    const noexcept { return const_iterator(&root); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend()   const noexcept { return end(); }
+    reverse_iterator       rbegin()       noexcept { return reverse_iterator(end()); }
+    reverse_iterator       rend()         noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()   const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend()   const noexcept { return rend(); }
+
+    // Link obj before pos; returns an iterator to obj.
+    iterator insert(const_iterator pos, T& obj) noexcept {
+        hook(obj)->link_before(pos.hook);
+        return iterator(hook(obj));
+    }
+    // Unlink the object at pos; returns the iterator after it.
+    iterator erase(const_iterator pos) noexcept {
+        hook_type* n = pos.hook->next;
+        pos.hook->unlink();
+        return iterator(n);
+    }
+    // Iterator to an object known to be in this list.
+    iterator       iterator_to(T& obj)             noexcept { return iterator(hook(obj)); }
+    const_iterator iterator_to(const T& obj) const noexcept { return const_iterator(hook(obj)); }
+
+    // Move every object of other to the back of this list in O(1).
+    void splice_back(IntrusiveList& other) noexcept;
+    // Unlink every object, O(n); the objects themselves are untouched.
+    void clear() noexcept;
+
+    bool        empty() const noexcept { return root.next == &root; }
+    std::size_t size() const noexcept  { return static_cast<std::size_t>(std::distance(begin(), end())); }
+    void        print_forward()  const;
+    void        print_backward() const;
+
+private:
+    hook_type root;
+
+    static hook_type*       hook(T& obj)       noexcept { return static_cast<hook_type*>(std::addressof(obj)); }
+    static const hook_type* hook(const T& obj) noexcept { return static_cast<const hook_type*>(std::addressof(obj)); }
+    static T&               object(hook_type* h)       noexcept { return *static_cast<T*>(h); }
+    static const T&         object(const hook_type* h) noexcept { return *static_cast<const T*>(h); }
+
+    T& take(hook_type* h) noexcept {
+        h->unlink();
+        return object(h);
+    }
+
+    IntrusiveList(const IntrusiveList&)            = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+};
+
+/*
+ basic_iterator – walks the ring; end() is the sentinel, so stepping back
+  from end() reaches the last object with no special case.
+ */
+template <typename T, typename Tag>
+template <bool Const>
+class IntrusiveList<T, Tag>::basic_iterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::conditional<Const, const T*, T*>::type;
+    using reference         = typename std::conditional<Const, const T&, T&>::type;
+
+    basic_iterator() : hook(nullptr) {}
+    template <bool C = Const, typename = typename std::enable_if<C>::type>
+    basic_iterator(const basic_iterator<false>& it) : hook(it.hook) {}
+
+    reference operator*()  const { return *static_cast<pointer>(hook); }
+    pointer   operator->() const { return static_cast<pointer>(hook); }
+
+    basic_iterator& operator++() { hook = hook->next; return *this; }
+    basic_iterator& operator--() { hook = hook->prev; return *this; }
+    basic_iterator  operator++(int) { basic_iterator t = *this; ++*this; return t; }
+    basic_iterator  operator--(int) { basic_iterator t = *this; --*this; return t; }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.hook == b.hook; }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b) { return a.hook != b.hook; }
+
+private:
+    friend class IntrusiveList;
+    friend class basic_iterator<!Const>;
+
+    hook_type* hook;
+
+    explicit basic_iterator(const hook_type* h) : hook(const_cast<hook_type*>(h)) {}
+};
+
+template <typename T, typename Tag>
+void IntrusiveList<T, Tag>::splice_back(IntrusiveList& other) noexcept {
+    if (other.empty() || &other == this) return;
+    hook_type* first = other.root.next;
+    hook_type* last  = other.root.prev;
+    other.root.prev = other.root.next = &other.root;
+
+    first->prev     = root.prev;
+    root.prev->next = first;
+    last->next      = &root;
+    root.prev       = last;
+}
+
+template <typename T, typename Tag>
+void IntrusiveList<T, Tag>::clear() noexcept {
+    hook_type* cur = root.next;
+    while (cur != &root) {
+        hook_type* nxt = cur->next;
+        cur->prev = cur->next = nullptr;
+        cur = nxt;
+    }
+    root.prev = root.next = &root;
+}
+
+template <typename T, typename Tag>
+void IntrusiveList<T, Tag>::print_forward() const {
+    dll_io::print_framed(dll_io::Direction::forward, [this](auto emit) {
+        for (const T& v : *this) emit(v);
+    });
+}
+
+template <typename T, typename Tag>
+void IntrusiveList<T, Tag>::print_backward() const {
+    dll_io::print_framed(dll_io::Direction::backward, [this](auto emit) {
+        for (auto r = rbegin(); r != rend(); ++r) emit(*r);
+    });
+}
+
+/*
+ ConcurrentNode – node of a ConcurrentDeque. Links are 32-bit indices into
+  the deque's node pool; `right` doubles as the free-stack link.
+ */
+template <typename T>
+struct ConcurrentNode {
+    union { T data; };
+    std::atomic<std::uint32_t> left;
+    std::atomic<std::uint32_t> right;
+
+    ConcurrentNode() : left(0), right(0) {}
+    ~ConcurrentNode() {}
+};
+
+/*
+ ConcurrentDeque – lock-free multi-producer/multi-consumer deque
+  (M. Michael, "CAS-Based Lock-Free Algorithm for Shared Deques", 2003).
+  The whole deque is described by one 64-bit anchor {left, right, status},
+  so every push/pop at either end is a single CAS on it, and a push leaves
+  the anchor "unstable" until the neighbour's back-link is fixed; any thread
+  that sees an unstable anchor helps finish that first.
+
+  Nodes are addressed by 31-bit index so the anchor fits a native CAS.
+  A popped node is retired with epoch-based reclamation and is only reused
+  once every thread that might still be reading it has left its operation.
+  Empty is a normal outcome here, so pops return std::optional.
+ */
+template <typename T>
+class ConcurrentDeque {
+public:
+    using value_type = T;
+    static constexpr std::size_t records_per_block = 32;  // epoch records claimed per block
+
+    ConcurrentDeque();
+    ~ConcurrentDeque();
+
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value)      { emplace_front(std::move(value)); }
+    void push_back(const T& value)  { emplace_back(value); }
+    void push_back(T&& value)       { emplace_back(std::move(value)); }
+
+    template <typename... Args> void emplace_front(Args&&... args);
+    template <typename... Args> void emplace_back(Args&&... args);
+
+    std::optional<T> pop_front();
+    std::optional<T> pop_back();
+
+    // A snapshot: another thread may change it right after.
+    bool empty() const { return right_of(anchor.load(std::memory_order_acquire)) == 0; }
+
+private:
+    using node_type = ConcurrentNode<T>;
+
+    enum : std::uint64_t { stable = 0, rpush = 1, lpush = 2 };
+
+    // anchor = left:31 | right:31 | status:2
+    static std::uint64_t pack(std::uint32_t l, std::uint32_t r, std::uint64_t s) {
+        return (std::uint64_t(l) << 33) | (std::uint64_t(r) << 2) | s;
+    }
+    static std::uint32_t left_of(std::uint64_t a)   { return std::uint32_t(a >> 33); }
+    static std::uint32_t right_of(std::uint64_t a)  { return std::uint32_t(a >> 2) & 0x7FFFFFFFu; }
+    static std::uint64_t status_of(std::uint64_t a) { return a & 3; }
+
+    /*
+     Node pool: segment s holds seg_base << s nodes, so an index maps to its
+     segment with one count-leading-zeros. Index 0 is the null link.
+     */
+    static constexpr unsigned      seg_shift = 6;
+    static constexpr std::size_t   seg_base  = std::size_t(1) << seg_shift;
+    static constexpr unsigned      seg_count = 31 - seg_shift;
+    static constexpr std::uint32_t max_index = 0x7FFFFFFFu;
+
+    // Per-thread epoch record plus three bags of retired node indices.
+    struct alignas(64) EpochRecord {
+        std::atomic<std::uintptr_t> owner{0};
+        std::atomic<std::uint64_t>  local{0};   // (epoch << 1) | 1 while inside an op
+        std::vector<std::uint32_t>  bag[3];
+        std::uint64_t               bag_epoch[3] = {0, 0, 0};
+    };
+
+    // Records come in blocks chained off the one embedded in the deque; a
+    // thread that finds every record taken appends a block by CAS on next.
+    struct RecordBlock {
+        EpochRecord               records[records_per_block];
+        std::atomic<RecordBlock*> next{nullptr};
+    };
+
+    // Guard – marks the calling thread active for the length of one operation.
+    class Guard {
+    public:
+        explicit Guard(ConcurrentDeque& q) : q(q), rec(q.record()) { q.enter(rec); }
+        ~Guard() { rec.local.store(0, std::memory_order_release); }
+        EpochRecord& record() { return rec; }
+
+    private:
+        ConcurrentDeque& q;
+        EpochRecord&     rec;
+    };
+
+    std::atomic<std::uint64_t> anchor;
+    std::atomic<std::uint64_t> free_top;    // index:32 | ABA tag:32
+    std::atomic<std::uint32_t> next_fresh;
+    std::atomic<node_type*>    segments[seg_count];
+    std::atomic<std::uint64_t> epoch;
+    RecordBlock                records;
+    std::uint64_t              id;
+
+    node_type& node(std::uint32_t i) const;
+    template <typename... Args> std::uint32_t make_node(Args&&... args);
+    void recycle(std::vector<std::uint32_t>& bag);
+
+    EpochRecord& record();
+    EpochRecord& claim_record(std::uintptr_t me);
+    static void  release_record(void* rec);
+    void enter(EpochRecord& rec);
+    void retire(EpochRecord& rec, std::uint32_t i);
+    void try_advance();
+
+    void stabilize(std::uint64_t a);
+    void stabilize_right(std::uint64_t a);
+    void stabilize_left(std::uint64_t a);
+    T    take(std::uint32_t i, EpochRecord& rec);
+
+    ConcurrentDeque(const ConcurrentDeque&)            = delete;
+    ConcurrentDeque& operator=(const ConcurrentDeque&) = delete;
+};
+
+template <typename T>
+ConcurrentDeque<T>::ConcurrentDeque()
+    : anchor(pack(0, 0, stable)), free_top(0), next_fresh(1), epoch(1),
+      id(dll_thread::enroll()) {
+    for (auto& s : segments) s.store(nullptr, std::memory_order_relaxed);
+}
+
+/*
+ Destructor – no other thread may be inside an operation. Finish a push that
+  was left unstable, destroy the live elements, then drop the segments.
+ */
+template <typename T>
+ConcurrentDeque<T>::~ConcurrentDeque() {
+    dll_thread::retire(id);
+    std::uint64_t a = anchor.load();
+    if (status_of(a) != stable) stabilize(a);
+    a = anchor.load();
+    if (!std::is_trivially_destructible<T>::value && right_of(a)) {
+        for (std::uint32_t i = left_of(a); ; i = node(i).right.load()) {
+            node(i).data.~T();
+            if (i == right_of(a)) break;
+        }
+    }
+    for (auto& s : segments)
+        ::operator delete(static_cast<void*>(s.load()));
+    for (RecordBlock* b = records.next.load(); b;) {
+        RecordBlock* next = b->next.load();
+        delete b;
+        b = next;
+    }
+}
+
+template <typename T>
+ConcurrentNode<T>& ConcurrentDeque<T>::node(std::uint32_t i) const {
+    std::size_t   k   = (std::size_t(i) >> seg_shift) + 1;
+    unsigned      s   = 63 - __builtin_clzll(k);
+    std::size_t   off = i - seg_base * ((std::size_t(1) << s) - 1);
+    return segments[s].load(std::memory_order_acquire)[off];
+}
+
+/*
+ make_node – pop the free stack, or bump a fresh index and, if it opens a new
+  segment, install that segment (the loser of an install race frees its copy).
+ */
+template <typename T>
+template <typename... Args>
+std::uint32_t ConcurrentDeque<T>::make_node(Args&&... args) {
+    std::uint32_t i   = 0;
+    std::uint64_t top = free_top.load(std::memory_order_acquire);
+    while (std::uint32_t(top)) {
+        std::uint32_t cand = std::uint32_t(top);
+        std::uint64_t next = std::uint64_t(node(cand).right.load(std::memory_order_relaxed))
+                           | (((top >> 32) + 1) << 32);
+        if (free_top.compare_exchange_weak(top, next, std::memory_order_acq_rel)) {
+            i = cand;
+            break;
+        }
+    }
+    if (!i) {
+        i = next_fresh.fetch_add(1, std::memory_order_relaxed);
+        if (i > max_index) throw std::length_error("ConcurrentDeque node pool exhausted");
+        std::size_t k = (std::size_t(i) >> seg_shift) + 1;
+        unsigned    s = 63 - __builtin_clzll(k);
+        if (!segments[s].load(std::memory_order_acquire)) {
+            std::size_t n     = seg_base << s;
+            node_type*  fresh = static_cast<node_type*>(::operator new(n * sizeof(node_type)));
+            for (std::size_t j = 0; j < n; ++j) new (&fresh[j]) node_type();
+            node_type* expected = nullptr;
+            if (!segments[s].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel))
+                ::operator delete(static_cast<void*>(fresh));
+        }
+    }
+    node_type& n = node(i);
+    n.left.store(0, std::memory_order_relaxed);
+    n.right.store(0, std::memory_order_relaxed);
+    try {
+        ::new (static_cast<void*>(std::addressof(n.data))) T(std::forward<Args>(args)...);
+    } catch (...) {
+        std::vector<std::uint32_t> one(1, i);
+        recycle(one);
+        throw;
+    }
+    return i;
+}
+
+// recycle – push a whole bag of reclaimed indices onto the free stack at once.
+template <typename T>
+void ConcurrentDeque<T>::recycle(std::vector<std::uint32_t>& bag) {
+    if (bag.empty()) return;
+    for (std::size_t j = 0; j + 1 < bag.size(); ++j)
+        node(bag[j]).right.store(bag[j + 1], std::memory_order_relaxed);
+    node_type&    last = node(bag.back());
+    std::uint64_t top  = free_top.load(std::memory_order_relaxed);
+    do {
+        last.right.store(std::uint32_t(top), std::memory_order_relaxed);
+    } while (!free_top.compare_exchange_weak(
+                 top, std::uint64_t(bag.front()) | (((top >> 32) + 1) << 32),
+                 std::memory_order_release, std::memory_order_relaxed));
+    bag.clear();
+}
+
+/*
+ record – find (or claim) this thread's epoch record. The thread identity is
+  the address of a thread_local, and the last lookup is cached per thread.
+ */
+template <typename T>
+typename ConcurrentDeque<T>::EpochRecord& ConcurrentDeque<T>::record() {
+    thread_local char          tag;
+    thread_local std::uint64_t cached_id  = 0;
+    thread_local EpochRecord*  cached_rec = nullptr;
+    if (cached_id == id) return *cached_rec;
+
+    std::uintptr_t me = reinterpret_cast<std::uintptr_t>(&tag);
+    EpochRecord*   r  = nullptr;
+    for (RecordBlock* b = &records; b && !r; b = b->next.load(std::memory_order_acquire))
+        for (EpochRecord& rec : b->records)
+            if (rec.owner.load(std::memory_order_relaxed) == me) {
+                r = &rec;
+                break;
+            }
+    if (!r) r = &claim_record(me);
+    cached_id  = id;
+    cached_rec = r;
+    return *r;
+}
+
+/*
+ claim_record – take the first free record, appending a block when there is
+  none, and have it freed again when the thread exits. A freed record keeps
+  its retire bags, which its next owner recycles once they are old enough;
+  nodes in a bag no thread claims again are released with the deque.
+ */
+template <typename T>
+typename ConcurrentDeque<T>::EpochRecord& ConcurrentDeque<T>::claim_record(std::uintptr_t me) {
+    for (RecordBlock* b = &records;;) {
+        for (EpochRecord& rec : b->records) {
+            std::uintptr_t expected = 0;
+            if (rec.owner.load(std::memory_order_relaxed) == 0 &&
+                rec.owner.compare_exchange_strong(expected, me, std::memory_order_acquire)) {
+                dll_thread::at_exit(id, &release_record, &rec);
+                return rec;
+            }
+        }
+        RecordBlock* next = b->next.load(std::memory_order_acquire);
+        if (!next) {
+            auto* fresh = new RecordBlock;
+            if (b->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel))
+                next = fresh;
+            else
+                delete fresh;
+        }
+        b = next;
+    }
+}
+
+template <typename T>
+void ConcurrentDeque<T>::release_record(void* rec) {
+    static_cast<EpochRecord*>(rec)->owner.store(0, std::memory_order_release);
+}
+
+/*
+ enter – publish the current epoch, then recycle any bag retired at least two
+  epochs ago: every thread active since then has moved past it.
+ */
+template <typename T>
+void ConcurrentDeque<T>::enter(EpochRecord& rec) {
+    std::uint64_t e = epoch.load(std::memory_order_acquire);
+    rec.local.store((e << 1) | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (int b = 0; b < 3; ++b)
+        if (!rec.bag[b].empty() && rec.bag_epoch[b] + 2 <= e) recycle(rec.bag[b]);
+}
+
+template <typename T>
+void ConcurrentDeque<T>::retire(EpochRecord& rec, std::uint32_t i) {
+    std::uint64_t e = rec.local.load(std::memory_order_relaxed) >> 1;
+    int           b = int(e % 3);
+    if (rec.bag_epoch[b] != e) {
+        recycle(rec.bag[b]);  // that bag is from epoch e - 3 or older
+        rec.bag_epoch[b] = e;
+    }
+    rec.bag[b].push_back(i);
+    if (rec.bag[b].size() % 64 == 0) try_advance();
+}
+
+// try_advance – bump the epoch once every active thread has seen the current one.
+template <typename T>
+void ConcurrentDeque<T>::try_advance() {
+    std::uint64_t e = epoch.load(std::memory_order_acquire);
+    for (RecordBlock* b = &records; b; b = b->next.load(std::memory_order_acquire))
+        for (const EpochRecord& rec : b->records) {
+            std::uint64_t l = rec.local.load(std::memory_order_acquire);
+            if ((l & 1) && (l >> 1) != e) return;
+        }
+    epoch.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+}
+
+template <typename T>
+void ConcurrentDeque<T>::stabilize(std::uint64_t a) {
+    if (status_of(a) == rpush) stabilize_right(a);
+    else                       stabilize_left(a);
+}
+
+/*
+ stabilize_right – after a push_back the old right end still has to point at
+  the new node; fix that link, then mark the anchor stable again.
+ */
+template <typename T>
+void ConcurrentDeque<T>::stabilize_right(std::uint64_t a) {
+    std::uint32_t r    = right_of(a);
+    std::uint32_t prev = node(r).left.load(std::memory_order_acquire);
+    if (anchor.load(std::memory_order_acquire) != a) return;
+    std::uint32_t prevnext = node(prev).right.load(std::memory_order_acquire);
+    if (prevnext != r) {
+        if (anchor.load(std::memory_order_acquire) != a) return;
+        if (!node(prev).right.compare_exchange_strong(prevnext, r, std::memory_order_acq_rel))
+            return;
+    }
+    anchor.compare_exchange_strong(a, pack(left_of(a), r, stable), std::memory_order_acq_rel);
+}
+
+template <typename T>
+void ConcurrentDeque<T>::stabilize_left(std::uint64_t a) {
+    std::uint32_t l    = left_of(a);
+    std::uint32_t next = node(l).right.load(std::memory_order_acquire);
+    if (anchor.load(std::memory_order_acquire) != a) return;
+    std::uint32_t nextprev = node(next).left.load(std::memory_order_acquire);
+    if (nextprev != l) {
+        if (anchor.load(std::memory_order_acquire) != a) return;
+        if (!node(next).left.compare_exchange_strong(nextprev, l, std::memory_order_acq_rel))
+            return;
+    }
+    anchor.compare_exchange_strong(a, pack(l, right_of(a), stable), std::memory_order_acq_rel);
+}
+
+template <typename T>
+template <typename... Args>
+void ConcurrentDeque<T>::emplace_back(Args&&... args) {
+    Guard         g(*this);
+    std::uint32_t n = make_node(std::forward<Args>(args)...);
+    std::uint64_t a = anchor.load(std::memory_order_acquire);
+    for (;;) {
+        if (right_of(a) == 0) {
+            if (anchor.compare_exchange_weak(a, pack(n, n, stable), std::memory_order_acq_rel))
+                return;
+        } else if (status_of(a) == stable) {
+            node(n).left.store(right_of(a), std::memory_order_relaxed);
+            std::uint64_t na = pack(left_of(a), n, rpush);
+            if (anchor.compare_exchange_weak(a, na, std::memory_order_acq_rel)) {
+                stabilize_right(na);
+                return;
+            }
+        } else {
+            stabilize(a);
+            a = anchor.load(std::memory_order_acquire);
+        }
+    }
+}
+
+template <typename T>
+template <typename... Args>
+void ConcurrentDeque<T>::emplace_front(Args&&... args) {
+    Guard         g(*this);
+    std::uint32_t n = make_node(std::forward<Args>(args)...);
+    std::uint64_t a = anchor.load(std::memory_order_acquire);
+    for (;;) {
+        if (left_of(a) == 0) {
+            if (anchor.compare_exchange_weak(a, pack(n, n, stable), std::memory_order_acq_rel))
+                return;
+        } else if (status_of(a) == stable) {
+            node(n).right.store(left_of(a), std::memory_order_relaxed);
+            std::uint64_t na = pack(n, right_of(a), lpush);
+            if (anchor.compare_exchange_weak(a, na, std::memory_order_acq_rel)) {
+                stabilize_left(na);
+                return;
+            }
+        } else {
+            stabilize(a);
+            a = anchor.load(std::memory_order_acquire);
+        }
+    }
+}
+
+// take – move the value out of a node this thread just unlinked, then retire it.
+template <typename T>
+T ConcurrentDeque<T>::take(std::uint32_t i, EpochRecord& rec) {
+    node_type& n = node(i);
+    T val(std::move(n.data));
+    n.data.~T();
+    retire(rec, i);
+    return val;
+}
+
+template <typename T>
+std::optional<T> ConcurrentDeque<T>::pop_back() {
+    Guard         g(*this);
+    std::uint64_t a = anchor.load(std::memory_order_acquire);
+    for (;;) {
+        std::uint32_t l = left_of(a), r = right_of(a);
+        if (r == 0) return std::nullopt;
+        if (r == l) {
+            if (anchor.compare_exchange_weak(a, pack(0, 0, stable), std::memory_order_acq_rel))
+                return take(r, g.record());
+        } else if (status_of(a) == stable) {
+            std::uint32_t prev = node(r).left.load(std::memory_order_acquire);
+            if (anchor.compare_exchange_weak(a, pack(l, prev, stable), std::memory_order_acq_rel))
+                return take(r, g.record());
+        } else {
+            stabilize(a);
+            a = anchor.load(std::memory_order_acquire);
+        }
+    }
+}
+
+template <typename T>
+std::optional<T> ConcurrentDeque<T>::pop_front() {
+    Guard         g(*this);
+    std::uint64_t a = anchor.load(std::memory_order_acquire);
+    for (;;) {
+        std::uint32_t l = left_of(a), r = right_of(a);
+        if (l == 0) return std::nullopt;
+        if (r == l) {
+            if (anchor.compare_exchange_weak(a, pack(0, 0, stable), std::memory_order_acq_rel))
+                return take(l, g.record());
+        } else if (status_of(a) == stable) {
+            std::uint32_t next = node(l).right.load(std::memory_order_acquire);
+            if (anchor.compare_exchange_weak(a, pack(next, r, stable), std::memory_order_acq_rel))
+                return take(l, g.record());
+        } else {
+            stabilize(a);
+            a = anchor.load(std::memory_order_acquire);
+        }
+    }
+}
+
+/*
+ WorkStealingDeque – Chase-Lev deque (with the weak-memory orderings of
+  Lê et al., PPoPP'13). The owner thread works the back end with
+  push_back/pop_back, touching only `bottom` except when racing a thief for
+  the last element; other threads steal() from the front with one CAS on
+  `top`. The ring grows by doubling; superseded rings are kept until the
+  deque dies because a thief may still be reading one.
+  Elements are copied racily, so T must be trivially copyable (task
+  pointers or ids).
+ */
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "WorkStealingDeque elements are copied racily");
+
+public:
+    using value_type = T;
+
+    explicit WorkStealingDeque(std::size_t capacity = 64);
+    ~WorkStealingDeque();
+
+    // Owner thread only.
+    void             push_back(T value);
+    std::optional<T> pop_back();
+    // Any thread.
+    std::optional<T> steal();
+
+    bool empty() const {
+        return top.load(std::memory_order_acquire) >= bottom.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Ring {
+        std::int64_t   mask;
+        std::atomic<T> slots[1];  // really mask + 1 slots
+
+        T    get(std::int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T v)  { slots[i & mask].store(v, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<std::int64_t> top;
+    alignas(64) std::atomic<std::int64_t> bottom;
+    std::atomic<Ring*> ring;
+    std::vector<Ring*> retired;  // owner only
+
+    static Ring* make_ring(std::size_t capacity);
+    static void  free_ring(Ring* r) { ::operator delete(static_cast<void*>(r)); }
+    Ring*        grow(Ring* old, std::int64_t b, std::int64_t t);
+
+    WorkStealingDeque(const WorkStealingDeque&)            = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+};
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(std::size_t capacity) : top(0), bottom(0) {
+    std::size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+    ring.store(make_ring(cap), std::memory_order_relaxed);
+}
+
+template <typename T>
+WorkStealingDeque<T>::~WorkStealingDeque() {
+    free_ring(ring.load(std::memory_order_relaxed));
+    for (Ring* r : retired) free_ring(r);
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Ring* WorkStealingDeque<T>::make_ring(std::size_t capacity) {
+    void* raw = ::operator new(sizeof(Ring) + (capacity - 1) * sizeof(std::atomic<T>));
+    Ring* r   = static_cast<Ring*>(raw);
+    r->mask   = std::int64_t(capacity) - 1;
+    for (std::size_t i = 0; i < capacity; ++i) new (&r->slots[i]) std::atomic<T>();
+    return r;
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Ring*
+WorkStealingDeque<T>::grow(Ring* old, std::int64_t b, std::int64_t t) {
+    Ring* r = make_ring(std::size_t(old->mask + 1) * 2);
+    for (std::int64_t i = t; i < b; ++i) r->put(i, old->get(i));
+    retired.push_back(old);
+    ring.store(r, std::memory_order_release);
+    return r;
+}
+
+template <typename T>
+void WorkStealingDeque<T>::push_back(T value) {
+    std::int64_t b = bottom.load(std::memory_order_relaxed);
+    std::int64_t t = top.load(std::memory_order_acquire);
+    Ring*        r = ring.load(std::memory_order_relaxed);
+    if (b - t > r->mask) r = grow(r, b, t);
+    r->put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+/*
+ pop_back – claim the bottom slot first, then look at top. Only when a single
+  element is left does the owner race thieves for it with a CAS on top.
+ */
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::pop_back() {
+    std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring*        r = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {                      // was already empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    std::optional<T> v(r->get(b));
+    if (t == b) {
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+            v.reset();                // a thief got it
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return v;
+}
+
+// steal – read the front element, then claim it; losing the CAS means "try again".
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::steal() {
+    std::int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return std::nullopt;
+
+    Ring* r = ring.load(std::memory_order_acquire);
+    T     v = r->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+        return std::nullopt;
+    return v;
+}
+
+/*
+ BatchChannel – many-producer, many-consumer channel that moves elements
+  in batches rather than one lock round-trip each. Every producer thread
+  owns a Producer handle that stages pushes in a private DoublyLinkedList
+  and publishes the whole batch with one O(1) splice under the channel
+  lock, once `batch` elements are staged or the oldest staged element is
+  `linger` old, or on flush(). A producer only reads the clock on every
+  16th push, and not at all once idle, so consumers also sweep the live
+  producers for batches that have lingered and publish those themselves:
+  an idle producer's last elements still arrive within about `linger`. For
+  that a blocked consumer wakes at least every `linger` while any Producer
+  exists. Consumers take everything published so far as one list, again in
+  O(1). Per-producer order is kept; batches from different producers
+  interleave whole.
+
+  Nodes are allocated on a producer's thread and freed on a consumer's,
+  so Allocator must be safe to use that way; the default one-node-per-new
+  HeapAllocator is. Pooling allocators also need their copies to absorb()
+  one another, or every splice degrades to moving element by element.
+ */
+template <typename T, typename Allocator = HeapAllocator<Node<T>>>
+class BatchChannel {
+public:
+    using value_type = T;
+    using list_type  = DoublyLinkedList<T, Allocator>;
+    using clock      = std::chrono::steady_clock;
+
+    class Producer;
+
+    explicit BatchChannel(std::size_t batch = 256,
+                          clock::duration linger = std::chrono::milliseconds(1),
+                          const Allocator& a = Allocator())
+        : batch_size(batch ? batch : 1), linger_time(linger), alloc(a), published(a) {}
+
+    // A staging handle for the calling thread; one per producing thread.
+    Producer producer() { return Producer(*this); }
+
+    // Everything published so far, possibly nothing. Never blocks.
+    list_type try_take_all();
+    // Block until something is published (or the channel is closed) and
+    // take it all; an empty list means closed and drained.
+    list_type take_all();
+    template <typename Rep, typename Period>
+    list_type take_all_for(std::chrono::duration<Rep, Period> timeout);
+
+    // Wake blocked consumers for good. Producers can still publish; their
+    // batches stay takeable. Closing flushes no producer: elements staged
+    // less than `linger` ago stay with their Producer until it flushes or is
+    // destroyed, even if take_all() has already reported closed and drained.
+    void close();
+
+    std::size_t     batch() const  { return batch_size; }
+    clock::duration linger() const { return linger_time; }
+
+private:
+    const std::size_t       batch_size;
+    const clock::duration   linger_time;
+    Allocator               alloc;
+    std::mutex              lock;
+    std::condition_variable ready;
+    list_type               published;
+    bool                    is_closed = false;
+    Producer*               producers = nullptr;   // live handles, under lock
+
+    void            publish(list_type& staged);
+    list_type       grab();                          // lock held
+    clock::duration sweep(clock::time_point now);    // lock held
+    void            enlist(Producer* p);
+    void            delist(Producer* p);
+};
+
+/*
+ Producer – stages elements for one thread. Not thread-safe itself, but a
+  consumer's sweep may publish its staged batch: a spin flag, only ever
+  contended by a sweep, guards the batch. Flushes whatever is left when
+  destroyed.
+ */
+template <typename T, typename Allocator>
+class BatchChannel<T, Allocator>::Producer {
+public:
+    Producer(Producer&& other)
+        : ch(other.ch), staged(take_staged(other)), opened(other.opened) { ch->enlist(this); }
+    ~Producer() {
+        flush();
+        ch->delist(this);
+    }
+
+    void push(const T& value) { emplace(value); }
+    void push(T&& value)      { emplace(std::move(value)); }
+    template <typename... Args> void emplace(Args&&... args);
+
+    // Publish the staged elements now (no-op if there are none).
+    void flush() {
+        Hold h(*this);
+        if (!staged.empty()) ch->publish(staged);
+    }
+    std::size_t pending() {
+        Hold h(*this);
+        return staged.size();
+    }
+
+private:
+    friend class BatchChannel;
+
+    struct Hold {
+        explicit Hold(Producer& p) : p(p) {
+            while (p.busy.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+        }
+        ~Hold() { p.busy.store(false, std::memory_order_release); }
+        Producer& p;
+    };
+
+    BatchChannel*     ch;
+    list_type         staged;
+    clock::time_point opened;   // when the first staged element arrived
+    std::atomic<bool> busy{false};
+    Producer*         prev_producer = nullptr;
+    Producer*         next_producer = nullptr;
+
+    explicit Producer(BatchChannel& owner) : ch(&owner), staged(owner.alloc) { ch->enlist(this); }
+    Producer& operator=(Producer&&) = delete;
+
+    static list_type take_staged(Producer& p) {
+        Hold h(p);
+        return list_type(std::move(p.staged));
+    }
+};
+
+// emplace – stage, then publish if the batch is full or has lingered. The clock
+// is read on every 16th push only; a consumer's sweep catches whatever lingers
+// in between.
+template <typename T, typename Allocator>
+template <typename... Args>
+void BatchChannel<T, Allocator>::Producer::emplace(Args&&... args) {
+    Hold h(*this);
+    staged.emplace_back(std::forward<Args>(args)...);
+    std::size_t n = staged.size();
+    if (n == 1) opened = clock::now();
+    if (n >= ch->batch_size || ((n & 15) == 0 && clock::now() - opened >= ch->linger_time))
+        ch->publish(staged);
+}
+
+// enlist – a consumer asleep with no producer to sweep must start sweeping.
+template <typename T, typename Allocator>
+void BatchChannel<T, Allocator>::enlist(Producer* p) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        p->next_producer = producers;
+        if (producers) producers->prev_producer = p;
+        producers = p;
+    }
+    ready.notify_all();
+}
+
+template <typename T, typename Allocator>
+void BatchChannel<T, Allocator>::delist(Producer* p) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (p->prev_producer) p->prev_producer->next_producer = p->next_producer;
+    else                  producers = p->next_producer;
+    if (p->next_producer) p->next_producer->prev_producer = p->prev_producer;
+}
+
+/*
+ sweep – publish every staged batch at least `linger` old and return how
+  long until the next one is, or duration::max() if nothing is staged.
+  Producers busy pushing are skipped; the caller looks again after `linger`.
+  Producer flags are only tried under the channel lock, never waited for,
+  so this cannot deadlock with a producer publishing.
+ */
+template <typename T, typename Allocator>
+typename BatchChannel<T, Allocator>::clock::duration
+BatchChannel<T, Allocator>::sweep(clock::time_point now) {
+    clock::duration due = clock::duration::max();
+    for (Producer* p = producers; p; p = p->next_producer) {
+        if (p->busy.exchange(true, std::memory_order_acquire)) {
+            due = std::min(due, linger_time);
+            continue;
+        }
+        if (!p->staged.empty()) {
+            clock::duration age = now - p->opened;
+            if (age >= linger_time) {
+                try {
+                    published.splice_back(p->staged);
+                } catch (...) {
+                    p->busy.store(false, std::memory_order_release);
+                    throw;
+                }
+            } else {
+                due = std::min(due, linger_time - age);
+            }
+        }
+        p->busy.store(false, std::memory_order_release);
+    }
+    return due;
+}
+
+// publish – splice the batch on under the lock; only an empty-to-non-empty
+// change can have a consumer waiting, so only that one notifies.
+template <typename T, typename Allocator>
+void BatchChannel<T, Allocator>::publish(list_type& staged) {
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        was_empty = published.empty();
+        published.splice_back(staged);
+    }
+    if (was_empty) ready.notify_one();
+}
+
+template <typename T, typename Allocator>
+typename BatchChannel<T, Allocator>::list_type BatchChannel<T, Allocator>::grab() {
+    list_type out(alloc);
+    out.splice_back(published);
+    return out;
+}
+
+template <typename T, typename Allocator>
+typename BatchChannel<T, Allocator>::list_type BatchChannel<T, Allocator>::try_take_all() {
+    std::lock_guard<std::mutex> guard(lock);
+    sweep(clock::now());
+    return grab();
+}
+
+template <typename T, typename Allocator>
+typename BatchChannel<T, Allocator>::list_type BatchChannel<T, Allocator>::take_all() {
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;) {
+        clock::duration due = sweep(clock::now());
+        if (!published.empty() || is_closed) return grab();
+        if (!producers) ready.wait(guard);
+        else            ready.wait_for(guard, std::min(due, linger_time));
+    }
+}
+
+template <typename T, typename Allocator>
+template <typename Rep, typename Period>
+typename BatchChannel<T, Allocator>::list_type
+BatchChannel<T, Allocator>::take_all_for(std::chrono::duration<Rep, Period> timeout) {
+    const clock::time_point      deadline = clock::now() + std::chrono::duration_cast<clock::duration>(timeout);
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;) {
+        clock::time_point now = clock::now();
+        clock::duration   due = sweep(now);
+        if (!published.empty() || is_closed || now >= deadline) return grab();
+        ready.wait_for(guard, std::min(producers ? std::min(due, linger_time) : due, deadline - now));
+    }
+}
+
+template <typename T, typename Allocator>
+void BatchChannel<T, Allocator>::close() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        is_closed = true;
+    }
+    ready.notify_all();
+}
+
+#if DLL_HAVE_COROUTINES
+/*
+ AsyncDeque – a DoublyLinkedList behind a mutex whose pops and pushes are
+  C++20 awaitables, so consumers suspend instead of spinning on empty():
+
+      std::optional<T> v = co_await q.pop_front();   // nullopt once closed and drained
+      bool ok = co_await q.push_back(x);             // false if the deque was closed
+
+  A push that finds a consumer waiting moves the value straight into that
+  consumer's awaiter and resumes it; the element never touches the list.
+  With a capacity, pushes to a full deque suspend until a pop frees a slot
+  and then land in the list directly; capacity 0 makes every push a
+  rendezvous with a pop. Waiters are resumed in arrival order, inline on
+  the thread whose push, pop or close() released them, after the lock is
+  dropped. Awaiters live in the suspended coroutine frames and are linked
+  through IntrusiveHook, so waiting allocates nothing. The deque must
+  outlive every coroutine suspended on it.
+ */
+template <typename T, typename Allocator = PoolAllocator<Node<T>>>
+class AsyncDeque {
+public:
+    using value_type = T;
+    static constexpr std::size_t unbounded = static_cast<std::size_t>(-1);
+
+    class PopAwaiter;
+    class PushAwaiter;
+
+    explicit AsyncDeque(std::size_t capacity = unbounded) : cap(capacity) {}
+
+    [[nodiscard]] PopAwaiter  pop_front() { return PopAwaiter(*this, false); }
+    [[nodiscard]] PopAwaiter  pop_back()  { return PopAwaiter(*this, true); }
+    [[nodiscard]] PushAwaiter push_front(T value) { return PushAwaiter(*this, std::move(value), false); }
+    [[nodiscard]] PushAwaiter push_back(T value)  { return PushAwaiter(*this, std::move(value), true); }
+
+    // Never suspend: nullopt when nothing is ready; false when full or
+    // closed, in which case value is left as it was.
+    std::optional<T> try_pop_front() { return try_pop(false); }
+    std::optional<T> try_pop_back()  { return try_pop(true); }
+    bool try_push_front(const T& value) { return try_push(value, false); }
+    bool try_push_front(T&& value)      { return try_push(std::move(value), false); }
+    bool try_push_back(const T& value)  { return try_push(value, true); }
+    bool try_push_back(T&& value)       { return try_push(std::move(value), true); }
+
+    // Refuse further pushes and release every waiter: waiting pops get
+    // nullopt, waiting pushes false. Elements already queued can still be
+    // popped.
+    void close();
+
+    bool closed() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return is_closed;
+    }
+    // Snapshots: another thread may change them right after.
+    std::size_t size() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return items.size();
+    }
+    bool        empty() const { return size() == 0; }
+    std::size_t capacity() const { return cap; }
+
+private:
+    mutable std::mutex             lock;
+    DoublyLinkedList<T, Allocator> items;
+    IntrusiveList<PopAwaiter>      consumers;   // only non-empty while items is empty
+    IntrusiveList<PushAwaiter>     producers;   // only non-empty while items is full
+    std::size_t                    cap;
+    bool                           is_closed = false;
+
+    std::optional<T> take(bool back, std::coroutine_handle<>& wake);
+    template <typename V> bool give(V&& value, bool back, std::coroutine_handle<>& wake);
+    std::optional<T> try_pop(bool back);
+    template <typename V> bool try_push(V&& value, bool back);
+
+    AsyncDeque(const AsyncDeque&)            = delete;
+    AsyncDeque& operator=(const AsyncDeque&) = delete;
+};
+
+// PopAwaiter – co_await yields the element, or nullopt once closed and empty.
+template <typename T, typename Allocator>
+class AsyncDeque<T, Allocator>::PopAwaiter : public IntrusiveHook<> {
+public:
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) {
+        std::coroutine_handle<>      wake;
+        std::unique_lock<std::mutex> guard(q->lock);
+        slot = q->take(back, wake);
+        if (!slot && !q->is_closed) {
+            handle = h;
+            q->consumers.push_back(*this);
+            return true;   // a push may resume us as soon as the lock drops
+        }
+        guard.unlock();
+        if (wake) wake.resume();
+        return false;
+    }
+    std::optional<T> await_resume() { return std::move(slot); }
+
+private:
+    friend class AsyncDeque;
+
+    AsyncDeque*             q;
+    bool                    back;
+    std::optional<T>        slot;
+    std::coroutine_handle<> handle;
+
+    PopAwaiter(AsyncDeque& owner, bool from_back) : q(&owner), back(from_back) {}
+};
+
+// PushAwaiter – co_await yields true once the value is queued or handed off.
+template <typename T, typename Allocator>
+class AsyncDeque<T, Allocator>::PushAwaiter : public IntrusiveHook<> {
+public:
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) {
+        std::coroutine_handle<>      wake;
+        std::unique_lock<std::mutex> guard(q->lock);
+        if (!q->is_closed) {
+            accepted = q->give(std::move(value), back, wake);
+            if (!accepted) {
+                handle = h;
+                q->producers.push_back(*this);
+                return true;
+            }
+        }
+        guard.unlock();
+        if (wake) wake.resume();
+        return false;
+    }
+    bool await_resume() const noexcept { return accepted; }
+
+private:
+    friend class AsyncDeque;
+
+    AsyncDeque*             q;
+    T                       value;
+    bool                    back;
+    bool                    accepted = false;
+    std::coroutine_handle<> handle;
+
+    PushAwaiter(AsyncDeque& owner, T&& v, bool to_back)
+        : q(&owner), value(std::move(v)), back(to_back) {}
+};
+
+/*
+ take – the next element for a consumer (lock held). Popping frees a slot,
+  so the longest-waiting producer's value moves into the list and wake is
+  set to resume it; with nothing queued, a waiting producer (capacity 0)
+  hands its value over directly. If the list cannot take the producer's
+  value, the producer keeps waiting.
+ */
+template <typename T, typename Allocator>
+std::optional<T> AsyncDeque<T, Allocator>::take(bool back, std::coroutine_handle<>& wake) {
+    std::optional<T> v;
+    if (!items.empty()) {
+        v.emplace(back ? items.pop_back() : items.pop_front());
+        if (!producers.empty() && items.size() < cap) {
+            PushAwaiter& p = producers.front();
+            try {
+                if (p.back) items.push_back(std::move(p.value));
+                else        items.push_front(std::move(p.value));
+            } catch (...) {
+                return v;
+            }
+            producers.pop_front();
+            p.accepted = true;
+            wake       = p.handle;
+        }
+    } else if (!producers.empty()) {
+        PushAwaiter& p = producers.pop_front();
+        v.emplace(std::move(p.value));
+        p.accepted = true;
+        wake       = p.handle;
+    }
+    return v;
+}
+
+// give – queue value or hand it to a waiting consumer (lock held, not
+// closed); false, with value untouched, if the list is full.
+template <typename T, typename Allocator>
+template <typename V>
+bool AsyncDeque<T, Allocator>::give(V&& value, bool back, std::coroutine_handle<>& wake) {
+    if (!consumers.empty()) {
+        PopAwaiter& c = consumers.front();
+        c.slot.emplace(std::forward<V>(value));
+        consumers.pop_front();
+        wake = c.handle;
+        return true;
+    }
+    if (items.size() >= cap) return false;
+    if (back) items.push_back(std::forward<V>(value));
+    else      items.push_front(std::forward<V>(value));
+    return true;
+}
+
+template <typename T, typename Allocator>
+std::optional<T> AsyncDeque<T, Allocator>::try_pop(bool back) {
+    std::coroutine_handle<>      wake;
+    std::unique_lock<std::mutex> guard(lock);
+    std::optional<T>             v = take(back, wake);
+    guard.unlock();
+    if (wake) wake.resume();
+    return v;
+}
+
+template <typename T, typename Allocator>
+template <typename V>
+bool AsyncDeque<T, Allocator>::try_push(V&& value, bool back) {
+    std::coroutine_handle<>      wake;
+    std::unique_lock<std::mutex> guard(lock);
+    bool ok = !is_closed && give(std::forward<V>(value), back, wake);
+    guard.unlock();
+    if (wake) wake.resume();
+    return ok;
+}
+
+template <typename T, typename Allocator>
+void AsyncDeque<T, Allocator>::close() {
+    IntrusiveList<PopAwaiter>  pops;
+    IntrusiveList<PushAwaiter> pushes;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        is_closed = true;
+        pops.splice_back(consumers);
+        pushes.splice_back(producers);
+    }
+    // Unlink each waiter before resuming it: its frame may go away at once.
+    while (PopAwaiter* c = pops.try_pop_front()) c->handle.resume();
+    while (PushAwaiter* p = pushes.try_pop_front()) p->handle.resume();
+}
+#endif // DLL_HAVE_COROUTINES
+
+/*
+ Explicit instantiations for the common element types. Linking the
+  dll_instances library defines DLL_EXTERN_TEMPLATES, so every including
+  translation unit skips instantiating these classes' out-of-line members
+  and uses the copies compiled once in src/dll_instances.cpp (which sets
+  DLL_EXTERN_TEMPLATE to nothing to turn the declarations into definitions).
+  Member templates (emplace_*, sort(Compare), ...) are still instantiated
+  where used, and inline members may still be inlined.
+ */
+#ifndef DLL_EXTERN_TEMPLATES
+#define DLL_EXTERN_TEMPLATES 0
+#endif
+#ifndef DLL_EXTERN_TEMPLATE
+#define DLL_EXTERN_TEMPLATE extern
+#endif
+
+#if DLL_EXTERN_TEMPLATES
+DLL_EXTERN_TEMPLATE template class NodePool<Node<int>>;
+DLL_EXTERN_TEMPLATE template class NodePool<Node<std::int64_t>>;
+DLL_EXTERN_TEMPLATE template class NodePool<Node<void*>>;
+DLL_EXTERN_TEMPLATE template class DoublyLinkedList<int>;
+DLL_EXTERN_TEMPLATE template class DoublyLinkedList<std::int64_t>;
+DLL_EXTERN_TEMPLATE template class DoublyLinkedList<void*>;
+DLL_EXTERN_TEMPLATE template class UnrolledList<int>;
+DLL_EXTERN_TEMPLATE template class UnrolledList<std::int64_t>;
+DLL_EXTERN_TEMPLATE template class IndexList<int>;
+DLL_EXTERN_TEMPLATE template class IndexList<std::int64_t>;
+#endif
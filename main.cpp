@@ -1,126 +1,84 @@
-
+#include <cstdio>
+#include <fstream>
 #include <iostream>
-#include <stdexcept>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doubly_linked_list.hpp"
 
 using std::cout;
 using std::endl;
 
-struct Node {
-    int   data;
-    Node* prev;
-    Node* next;
-
-    explicit Node(int value) : data(value), prev(nullptr), next(nullptr) {}
-};
-
-
-class DoublyLinkedList {
-public:
-    DoublyLinkedList() : head(nullptr), tail(nullptr), size_(0) {}
-    ~DoublyLinkedList();
-
-  
-    void push_front(int value);
-    void push_back(int value);
-    int  pop_front();
-    int  pop_back();
-=
-    std::size_t size() const { return size_; }
-    bool        empty() const { return size_ == 0; }
-    void        print_forward()  const;
-    void        print_backward() const;
-
-private:
-    Node* head;
-    Node* tail;
-    std::size_t size_;
-
-    
-    DoublyLinkedList(const DoublyLinkedList&)            = delete;
-    DoublyLinkedList& operator=(const DoublyLinkedList&) = delete;
+// A connection that can sit in one IntrusiveList at a time.
+struct Connection : IntrusiveHook<> {
+    int id;
+    explicit Connection(int i) : id(i) {}
 };
 
-/* 
- Destructor – walk from head and delete nodes.
-  O(n) time, O(1) extra space.
- */
-DoublyLinkedList::~DoublyLinkedList() {
-    Node* cur = head;
-    while (cur) {
-        Node* next = cur->next;
-        delete cur;
-        cur = next;
-    }
-}
+std::ostream& operator<<(std::ostream& os, const Connection& c) { return os << "#" << c.id; }
 
-
-void DoublyLinkedList::push_front(int value) {
-    Node* n = new Node(value);
-    n->next = head;         // new node points forward
-    if (head) head->prev = n;
-    head = n;
-    if (!tail) tail = n;    // list was empty
-    ++size_;
+// A ring of the last four request ids, built entirely at compile time.
+constexpr StaticDoublyLinkedList<int, 4, OverflowPolicy::overwrite_oldest> recent_requests() {
+    StaticDoublyLinkedList<int, 4, OverflowPolicy::overwrite_oldest> ring;
+    for (int id = 100; id < 106; ++id) ring.push_back(id);
+    return ring;
 }
+constexpr auto startup_ring = recent_requests();
+static_assert(startup_ring.front() == 102 && startup_ring.size() == 4, "oldest two overwritten");
 
-/* 
- push_back – append a new value in symmetric fashion.
+/*
+ work_stealing_demo – a tiny thread pool. Each worker owns a
+  WorkStealingDeque of task sizes; a task larger than one splits itself in
+  two and pushes both halves locally. All work starts on worker 0, so the
+  others only get anything by stealing. Returns the number of unit tasks run.
  */
-void DoublyLinkedList::push_back(int value) {
-    Node* n = new Node(value);
-    n->prev = tail;
-    if (tail) tail->next = n;
-    tail = n;
-    if (!head) head = n;
-    ++size_;
-}
-
+long work_stealing_demo(unsigned workers, int root_size) {
+    std::vector<std::unique_ptr<WorkStealingDeque<int>>> queues;
+    for (unsigned w = 0; w < workers; ++w)
+        queues.emplace_back(new WorkStealingDeque<int>());
 
-int DoublyLinkedList::pop_front() {
-    if (empty()) throw std::underflow_error("pop_front on empty list");
-    Node* n = head;
-    int   val = n->data;
-    head = head->next;
-    if (head) head->prev = nullptr;
-    else      tail = nullptr;  // list became empty
-    delete n;
-    --size_;
-    return val;
-}
-
-int DoublyLinkedList::pop_back() {
-    if (empty()) throw std::underflow_error("pop_back on empty list");
-    Node* n = tail;
-    int   val = n->data;
-    tail = tail->prev;
-    if (tail) tail->next = nullptr;
-    else      head = nullptr;
-    delete n;
-    --size_;
-    return val;
-}
+    std::atomic<long> pending(1);   // tasks pushed but not yet finished
+    std::atomic<long> leaves(0);
+    queues[0]->push_back(root_size);
 
-/*  print_forward / print_backward –  traversals to
- verify links
- */
-void DoublyLinkedList::print_forward() const {
-    cout << "[head] ";
-    for (Node* cur = head; cur; cur = cur->next)
-        cout << cur->data << " ";
-    cout << "[null]" << endl;
-}
+    auto worker = [&](unsigned self) {
+        unsigned victim = self;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            std::optional<int> task = queues[self]->pop_back();
+            if (!task) {
+                victim = (victim + 1) % workers;
+                if (victim == self) continue;
+                task = queues[victim]->steal();
+                if (!task) {
+                    std::this_thread::yield();
+                    continue;
+                }
+            }
+            if (*task > 1) {
+                pending.fetch_add(2, std::memory_order_relaxed);
+                queues[self]->push_back(*task / 2);
+                queues[self]->push_back(*task - *task / 2);
+            } else {
+                leaves.fetch_add(1, std::memory_order_relaxed);
+            }
+            pending.fetch_sub(1, std::memory_order_release);
+        }
+    };
 
-void DoublyLinkedList::print_backward() const {
-    cout << "[tail] ";
-    for (Node* cur = tail; cur; cur = cur->prev)
-        cout << cur->data << " ";
-    cout << "[null]" << endl;
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < workers; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for (std::thread& t : pool) t.join();
+    return leaves.load();
 }
 
 //Builds a list, shows its state after each operation, then  it pops from both ends.
- 
+
 int main() {
-    DoublyLinkedList dll;
+    DoublyLinkedList<int> dll;
 
     cout << "Pushing 3, 2, 1 at the front…" << endl;
     dll.push_front(3);
@@ -139,4 +97,256 @@ int main() {
     cout << "Popping back:   " << dll.pop_back()  << endl;   // 5
     dll.print_forward();                                      // 2 3 4
     cout << "\nSize now: " << dll.size() << endl;
+
+    // Two lists drawing nodes from one shared arena.
+    using SharedInt = SharedPoolAllocator<Node<int>>;
+    NodePool<Node<int>> arena;
+    DoublyLinkedList<int, SharedInt> a{SharedInt(arena)};
+    DoublyLinkedList<int, SharedInt> b{SharedInt(arena)};
+    for (int i = 0; i < 4; ++i) { a.push_back(i); b.push_front(i); }
+    cout << "\nShared arena lists:" << endl;
+    a.print_forward();     // 0 1 2 3
+    b.print_forward();     // 3 2 1 0
+
+    // Per-worker batches concatenated without copying.
+    DoublyLinkedList<int> batch1, batch2;
+    for (int i = 0; i < 3; ++i) { batch1.push_back(i); batch2.push_back(i + 10); }
+    batch1.splice_back(batch2);
+    DoublyLinkedList<int> tail_half = batch1.split_at(4);
+    cout << "\nSpliced then split:" << endl;
+    batch1.print_forward();     // 0 1 2 10
+    tail_half.print_forward();  // 11 12
+    batch1.merge(tail_half);
+    batch1.print_forward();     // 0 1 2 10 11 12
+
+    // Unrolled variant: four ints per chunk, same two-ended API.
+    UnrolledList<int, 4> ul;
+    for (int i = 1; i <= 6; ++i) ul.push_back(i);
+    ul.push_front(0);
+    cout << "\nUnrolled list:" << endl;
+    ul.print_forward();    // 0 1 2 3 4 5 6
+    ul.print_backward();   // 6 5 4 3 2 1 0
+
+    // Persistent variant: a snapshot keeps its view while the list moves on.
+    PersistentList<int, 4> pl;
+    for (int i = 0; i < 6; ++i) pl.push_back(i);
+    PersistentList<int, 4>::Snapshot before = pl.snapshot();
+    pl.pop_front();
+    pl.pop_back();
+    pl.push_back(9);
+    cout << "\nPersistent list and an earlier snapshot:" << endl;
+    pl.print_forward();      // 1 2 3 4 9
+    before.print_forward();  // 0 1 2 3 4 5
+
+    // XOR-linked variant: one link word per node, walkable from either end.
+    XorLinkedList<int> xl;
+    for (int i = 1; i <= 4; ++i) xl.push_back(i);
+    xl.push_front(0);
+    xl.reverse();
+    cout << "\nXOR-linked list (" << sizeof(XorNode<int>) << "-byte nodes):" << endl;
+    xl.print_forward();    // 4 3 2 1 0
+    xl.print_backward();   // 0 1 2 3 4
+
+    // Index-based variant: handles allow O(1) erase and reordering.
+    IndexList<int> il;
+    IndexList<int>::handle h1 = il.push_back(1);
+    il.push_back(2);
+    IndexList<int>::handle h3 = il.push_back(3);
+    il.move_to_front(h3);
+    il.erase(h1);
+    cout << "\nIndex list:" << endl;
+    il.print_forward();    // 3 2
+
+    // Iterators: range-for, <algorithm> and O(1) insert/erase in place.
+    DoublyLinkedList<int> it_list;
+    for (int i = 1; i <= 5; ++i) it_list.push_back(i);
+    auto three = std::find(it_list.begin(), it_list.end(), 3);
+    it_list.insert(it_list.erase(three), 30);
+    cout << "\nIterated:  ";
+    for (int v : it_list) cout << v << " ";                   // 1 2 30 4 5
+    cout << "\nReversed:  ";
+    for (auto r = it_list.crbegin(); r != it_list.crend(); ++r) cout << *r << " ";
+    cout << endl;                                             // 5 4 30 2 1
+
+    // Sorting relinks nodes in place; unique and insert_sorted keep it sorted.
+    DoublyLinkedList<int> sorted;
+    for (int v : {5, 3, 9, 3, 1, 5, 7}) sorted.push_back(v);
+    sorted.sort();
+    sorted.unique();
+    sorted.insert_sorted(4);
+    cout << "\nSorted:    ";
+    for (int v : sorted) cout << v << " ";                    // 1 3 4 5 7 9
+    cout << endl;
+
+    // Sorting left the nodes scattered; relayout puts them back in list
+    // order, and stream() walks with prefetching.
+    sorted.relayout();
+    cout << "Relaid:    ";
+    for (int v : sorted.stream()) cout << v << " ";           // 1 3 4 5 7 9
+    cout << endl;
+
+    // Skip-list lanes over the list: positional and sorted lookups in O(log n).
+    SkipIndexedList<int> ranked;
+    for (int v = 0; v < 100000; v += 2) ranked.push_back(v);
+    ranked.insert_sorted(4321);
+    SkipIndexedList<int> upper = ranked.split_at(25000);
+    cout << "Ranked:    at(2160)=" << ranked.at(2160) << " lower_bound(4321)="
+         << ranked.lower_bound(4321) << " upper.front()=" << upper.front() << endl;
+                                                 // at(2160)=4320 lower_bound(4321)=2161 upper.front()=49998
+
+    // Lock-free deque shared by two producer threads; empty pops return nullopt.
+    ConcurrentDeque<int> work;
+    std::thread producer_a([&work] { for (int i = 0; i < 1000; ++i) work.push_back(i); });
+    std::thread producer_b([&work] { for (int i = 0; i < 1000; ++i) work.push_front(i); });
+    producer_a.join();
+    producer_b.join();
+    long drained = 0;
+    while (std::optional<int> v = work.pop_front()) drained += *v;
+    cout << "\nConcurrent deque drained sum: " << drained << endl; // 999000
+
+    // Batched channel: each producer stages 64 pushes per publish; the
+    // consumer takes every published batch in one splice.
+    BatchChannel<int> channel(64);
+    std::thread batch_a([&channel] { auto p = channel.producer(); for (int i = 0; i < 1000; ++i) p.push(i); });
+    std::thread batch_b([&channel] { auto p = channel.producer(); for (int i = 0; i < 1000; ++i) p.push(i); });
+    long channel_sum = 0, channel_items = 0, batches = 0;
+    while (channel_items < 2000) {
+        BatchChannel<int>::list_type part = channel.take_all();
+        for (int v : part) channel_sum += v;
+        channel_items += static_cast<long>(part.size());
+        ++batches;
+    }
+    batch_a.join();
+    batch_b.join();
+    cout << "Batch channel sum: " << channel_sum << " in " << batches << " takes" << endl; // 999000
+
+    // NUMA-placed nodes: allocated by the producer on the consumer's node,
+    // freed by the consumer back to the node they came from.
+    NumaNodePool<Node<int>> numa_pool;
+    using NumaInts = NumaPoolAllocator<Node<int>>;
+    BatchChannel<int, NumaInts> placed(64, std::chrono::milliseconds(1),
+                                       NumaInts(numa_pool, static_cast<int>(dll_numa::current_node())));
+    std::thread placer([&placed] { auto p = placed.producer(); for (int i = 0; i < 1000; ++i) p.push(i); });
+    long placed_sum = 0, placed_items = 0;
+    while (placed_items < 1000) {
+        BatchChannel<int, NumaInts>::list_type part = placed.take_all();
+        for (int v : part) placed_sum += v;
+        placed_items += static_cast<long>(part.size());
+    }
+    placer.join();
+    cout << "NUMA-placed sum: " << placed_sum << " across " << numa_pool.homes() << " node(s)" << endl; // 499500
+
+    // Work-stealing pool: all work starts on one worker, the rest steal it.
+    cout << "Work-stealing pool ran " << work_stealing_demo(4, 10000)
+         << " unit tasks" << endl;               // 10000
+
+    // Polling without exceptions, and draining in bulk.
+    DoublyLinkedList<int> polled;
+    for (int i = 0; i < 6; ++i) polled.push_back(i);
+    std::vector<int> drained_front;
+    polled.pop_front_n(std::back_inserter(drained_front), 4);
+    cout << "\nDrained " << drained_front.size() << ", front/back now "
+         << polled.front() << "/" << polled.back() << endl;   // 4, 4/5
+    while (std::optional<int> v = polled.try_pop_back()) cout << "try_pop_back " << *v << endl;
+
+    // Bulk construction: one pool run, one splice.
+    std::vector<int> seed {7, 8, 9};
+    DoublyLinkedList<int> bulk(seed.begin(), seed.end());
+    bulk.prepend_range(seed.rbegin(), seed.rend());
+    bulk.insert_range(std::next(bulk.begin(), 3), seed.begin(), seed.begin() + 1);
+    cout << "\nBulk built:" << endl;
+    bulk.print_forward();  // 9 8 7 7 7 8 9
+
+    // Non-trivial payloads are built in place and moved back out.
+    DoublyLinkedList<std::string> words;
+    words.emplace_back(3, 'x');
+    words.push_front(std::string("front"));
+    cout << "\nString list:" << endl;
+    words.print_forward();                       // front xxx
+    cout << "Moved out: " << words.pop_back() << endl; // xxx
+
+    // Intrusive list: objects carry their own links, so moving between lists
+    // and unlinking themselves never touches the heap.
+    Connection c1(1), c2(2), c3(3);
+    IntrusiveList<Connection> idle, busy;
+    idle.push_back(c1);
+    idle.push_back(c2);
+    idle.push_back(c3);
+    busy.push_back(c2);        // moves c2 out of idle
+    c3.unlink();               // O(1) self-unlink
+    cout << "\nIntrusive lists:" << endl;
+    idle.print_forward();      // #1
+    busy.print_forward();      // #2
+
+    // LRU cache: a hit moves the entry to the front, a full cache evicts the back.
+    LruCache<int, std::string> lru(2);
+    lru.put(1, "one");
+    lru.put(2, "two");
+    lru.get(1);
+    lru.put(3, "three");       // evicts 2
+    cout << "\nLRU order:";
+    lru.for_each([](int k, const std::string& v) { cout << " " << k << "=" << v; });
+    cout << endl;              // 3=three 1=one
+
+    // Parallel reduction: sum of the positive values, every core sharing the scan.
+    DoublyLinkedList<int> signed_vals;
+    for (int i = -500000; i < 500000; ++i) signed_vals.push_back(i % 7 == 0 ? -i : i);
+    long positive_sum = signed_vals.parallel_reduce(
+        0L, [](long acc, int v) { return v > 0 ? acc + v : acc; }, std::plus<long>());
+    cout << "\nParallel sum of positives: " << positive_sum << ", "
+         << signed_vals.parallel_count_if([](int v) { return v > 0; }) << " positives" << endl;
+
+    // Vectorized scans over the unrolled layout (kernels chosen for this CPU).
+    UnrolledList<int> scanned;
+    for (int i = -1000; i < 1000; ++i) scanned.push_back(i);
+    cout << "\nUnrolled scans: sum " << scanned.sum() << ", sum of positives "
+         << scanned.sum_positive() << ", min " << *scanned.min() << ", max " << *scanned.max()
+         << ", 42 at " << scanned.find(42) << endl;  // -1000, 499500, -1000, 999, 1042
+
+    // Small-buffer list: the first four nodes sit inside the object itself.
+    SmallDoublyLinkedList<int, 4> small;
+    for (int i = 1; i <= 6; ++i) small.push_back(i * 11);   // 55 and 66 spill to the pool
+    SmallDoublyLinkedList<int, 4> moved_small(std::move(small));
+    cout << "\nSmall list (4 inline):" << endl;
+    moved_small.print_forward();   // 11 22 33 44 55 66
+
+    // Fixed-capacity list: no heap, and a full list reports instead of growing.
+    StaticDoublyLinkedList<int, 2> bounded;
+    bounded.push_back(1);
+    bounded.push_back(2);
+    cout << "\nStatic list full push rejected: "
+         << (bounded.push_back(3) == PushStatus::full ? "yes" : "no") << endl;
+    startup_ring.print_forward();  // 102 103 104 105
+
+    // Checkpoint and restore: streamed back in, or mapped straight from disk.
+    {
+        const char* path = "dll_demo.snap";
+        {
+            std::ofstream out(path, std::ios::binary);
+            bulk.save_snapshot(out);
+        }
+        DoublyLinkedList<int> restored;
+        restored.load_snapshot(path);
+        cout << "\nRestored from snapshot:" << endl;
+        restored.print_forward();  // 9 8 7 7 7 8 9
+
+        {
+            std::ofstream out(path, std::ios::binary);
+            il.save_snapshot(out);
+        }
+        IndexList<int> mapped = IndexList<int>::map_snapshot(path);
+        mapped.push_front(1);      // first growth copies out of the mapping
+        cout << "Mapped index list:" << endl;
+        mapped.print_forward();    // 1 3 2
+        std::remove(path);
+    }
+
+#if DLL_ENABLE_STATS
+    dll_stats::Counters st = dll_stats::snapshot();
+    cout << "\nStats: push " << st.push_front << "/" << st.push_back
+         << "  pop " << st.pop_front << "/" << st.pop_back
+         << "  empty pops " << st.empty_pops
+         << "  node allocs " << st.node_allocs
+         << "  peak size " << st.peak_size << endl;
+#endif
 }
@@ -0,0 +1,5 @@
+// dll_instances.cpp – the one translation unit that instantiates the classes
+// doubly_linked_list.hpp declares extern under DLL_EXTERN_TEMPLATES.
+#define DLL_EXTERN_TEMPLATES 1
+#define DLL_EXTERN_TEMPLATE
+#include "doubly_linked_list.hpp"